@@ -0,0 +1,85 @@
+#include "asyncjob.h"
+#include <QMutexLocker>
+#include <QThread>
+
+class AsyncJob::DriverThread : public QThread {
+private:
+    AsyncJob* m_job;
+
+public:
+    explicit DriverThread(AsyncJob* job) : m_job(job) {}
+
+protected:
+    void run() override {
+        if (!m_job->isCancelled()) m_job->m_body(m_job);
+        m_job->m_runTimeMs = m_job->m_timer.elapsed();
+        if (m_job->m_finishHandler) m_job->m_finishHandler(m_job);
+        emit m_job->finished(m_job->isCancelled());
+    }
+};
+
+AsyncJob::AsyncJob(const QString& name, Body body, QObject* parent)
+    : QObject(parent), m_name(name), m_body(body), m_thread(new DriverThread(this)), m_cancelled(0),
+      m_priority(NormalPriority), m_threadShare(0), m_workItems(0), m_queueTimeMs(0), m_runTimeMs(0),
+      m_lastPercent(-1) {
+    m_timer.start();
+}
+
+AsyncJob::~AsyncJob() {
+    cancel();
+    wait();
+    delete m_thread;
+}
+
+const char* AsyncJob::priorityName(Priority priority) {
+    switch (priority) {
+    case LowPriority: return "low";
+    case HighPriority: return "high";
+    default: return "normal";
+    }
+}
+
+void AsyncJob::setWorkSize(qint64 items, const QString& unit) {
+    m_workItems = items;
+    m_workUnit = unit;
+}
+
+double AsyncJob::throughput() const {
+    return m_runTimeMs > 0 ? m_workItems * 1000.0 / m_runTimeMs : 0.0;
+}
+
+void AsyncJob::start() {
+    m_queueTimeMs = m_timer.restart();
+    m_thread->start();
+}
+
+void AsyncJob::cancel() {
+    m_cancelled.storeRelease(1);
+}
+
+void AsyncJob::wait() {
+    m_thread->wait();
+}
+
+void AsyncJob::beginPhase(const QString& phase) {
+    {
+        QMutexLocker locker(&m_progressMutex);
+        m_phase = phase;
+        m_lastPercent = 0;
+    }
+    emit progressChanged(0, phase);
+}
+
+void AsyncJob::updateProgress(qint64 done, qint64 total) {
+    int percent = total > 0 ? (int)(done * 100 / total) : 100;
+    QString phase;
+    {
+        // Only whole-percent changes are forwarded, so pool threads cannot
+        // flood the GUI event queue.
+        QMutexLocker locker(&m_progressMutex);
+        if (percent <= m_lastPercent) return;
+        m_lastPercent = percent;
+        phase = m_phase;
+    }
+    emit progressChanged(percent, phase);
+}
@@ -0,0 +1,104 @@
+#ifndef ASYNCJOB_H
+#define ASYNCJOB_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <functional>
+
+class QThread;
+
+// Runs one workload body on its own driver thread so the GUI thread never
+// blocks. The body orchestrates pool work (and may wait on it); progress and
+// completion reach the GUI as queued signals. Cancellation is cooperative:
+// TaskGraph skips nodes that have not started yet and bodies check
+// isCancelled() between phases. A job cancelled before it starts never runs
+// its body.
+//
+// Several jobs can share one pool (see JobScheduler). A job's priority
+// orders its nodes in the pool queue, and its thread share caps how many
+// pool threads its loops occupy at once.
+class AsyncJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<void(AsyncJob* job)> Body;
+    typedef std::function<void(AsyncJob* job)> FinishHandler;
+
+    // Values are QThreadPool::start() priorities; plain TaskGraphs use 0.
+    enum Priority {
+        LowPriority = -1,
+        NormalPriority = 0,
+        HighPriority = 1
+    };
+
+    AsyncJob(const QString& name, Body body, QObject* parent = nullptr);
+    ~AsyncJob(); // Cancels and joins the driver thread
+
+    QString name() const { return m_name; }
+
+    void setPriority(Priority priority) { m_priority = priority; }
+    Priority priority() const { return m_priority; }
+    static const char* priorityName(Priority priority);
+
+    // Pool threads this job's loops may occupy at once; 0 (the default)
+    // means the whole pool. Thread-safe, and may change while the job runs.
+    void setThreadShare(int threads) { m_threadShare.storeRelease(threads); }
+    int threadBudget(int poolThreads) const {
+        int share = m_threadShare.loadAcquire();
+        return share > 0 && share < poolThreads ? share : poolThreads;
+    }
+
+    // Amount of work in the job, for throughput(): e.g. 10000000 "elements".
+    void setWorkSize(qint64 items, const QString& unit);
+    QString workUnit() const { return m_workUnit; }
+
+    // Called on the driver thread once the body has returned, before
+    // finished() is emitted.
+    void setFinishHandler(FinishHandler handler) { m_finishHandler = handler; }
+
+    void start();
+    void cancel();       // Thread-safe
+    void wait();         // Blocks until the body has returned
+    bool isCancelled() const { return m_cancelled.loadAcquire() != 0; }
+
+    // Queue time runs from construction to start(), run time from start()
+    // until the body returns. Valid once finished() has been emitted.
+    qint64 queueTimeMs() const { return m_queueTimeMs; }
+    qint64 runTimeMs() const { return m_runTimeMs; }
+    double throughput() const; // Work items per second of run time, 0 if unknown
+
+    // Called from the body or from pool threads.
+    void beginPhase(const QString& phase);
+    void updateProgress(qint64 done, qint64 total);
+
+signals:
+    void progressChanged(int percent, const QString& phase);
+    void finished(bool cancelled);
+
+private:
+    class DriverThread;
+
+    QString m_name;
+    Body m_body;
+    FinishHandler m_finishHandler;
+    QThread* m_thread;
+    QAtomicInt m_cancelled;
+    Priority m_priority;
+    QAtomicInt m_threadShare;
+    qint64 m_workItems;
+    QString m_workUnit;
+
+    QElapsedTimer m_timer; // Started at construction, restarted by start()
+    qint64 m_queueTimeMs;
+    qint64 m_runTimeMs;
+
+    QMutex m_progressMutex;
+    QString m_phase;
+    int m_lastPercent;
+};
+
+#endif // ASYNCJOB_H
@@ -0,0 +1,15 @@
+# bench.pro
+# Headless benchmark runner: runs the three workloads with configurable
+# sizes, thread counts and repetitions and prints the timings as JSON.
+QT       += core
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = parallelbench
+
+include(../parallelcore.pri)
+
+SOURCES += \
+    benchmain.cpp
@@ -0,0 +1,594 @@
+// === benchmain.cpp ===
+// Headless benchmark driver. Every configuration is run --reps times on its
+// own pool; results go to stdout (or --output) as one JSON document, with
+// progress text on stderr when --verbose is given, and a Chrome trace of
+// every task when --trace is given.
+#include "asyncjob.h"
+#include "counterrng.h"
+#include "jobscheduler.h"
+#include "numaplacement.h"
+#include "outputlog.h"
+#include "parallelsort.h"
+#include "parallelverify.h"
+#include "simdsort.h"
+#include "stringmatrix.h"
+#include "stringsort.h"
+#include "tasktrace.h"
+#include "workloads.h"
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QSysInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+struct BenchConfig {
+    QStringList tasks;
+    QList<int> modes;           // ParallelSorter<int>::SortMode values
+    QList<int> threadCounts;
+    int reps;
+    quint64 seed;
+    int corePercent;
+    bool verbose;
+
+    int vectorSize;
+    int stringRows;
+    int stringCols;
+    int stringLength;
+    QStringList stringStorages; // "packed" (PackedStringMatrix), "qstring" (per row) and/or "qstring-global"
+    int urlCount;
+    int decrementSize;
+    int decrementMaxValue;
+    QStringList decrementModes; // "active" (DecrementProcessor::ActiveSet) or "full" (FullScan), "-team" for PersistentTeam
+};
+
+// min / median / p95 (nearest rank) of one configuration's repetitions, in ms.
+struct TimingStats {
+    double min;
+    double median;
+    double p95;
+
+    static TimingStats of(std::vector<double> samples) {
+        TimingStats stats = {0, 0, 0};
+        if (samples.empty()) return stats;
+        std::sort(samples.begin(), samples.end());
+        size_t n = samples.size();
+        stats.min = samples.front();
+        stats.median = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        stats.p95 = samples[std::max<size_t>(1, (size_t)std::ceil(0.95 * n)) - 1];
+        return stats;
+    }
+
+    QJsonObject toJson() const {
+        QJsonObject o;
+        o["min"] = min;
+        o["median"] = median;
+        o["p95"] = p95;
+        return o;
+    }
+};
+
+static double elapsedMs(const QElapsedTimer& timer) {
+    return timer.nsecsElapsed() / 1e6;
+}
+
+static const char* modeName(int mode) {
+    switch (mode) {
+    case ParallelSorter<int>::RadixSort: return "radix";
+    case ParallelSorter<int>::SampleSort: return "sample";
+    default: return "merge";
+    }
+}
+
+// Single-threaded std::sort on the same seeded input; independent of the
+// thread count, so measured once per run.
+static TimingStats sortBaseline(const BenchConfig& config, QThreadPool* pool) {
+    OverwriteVector<int> data(config.vectorSize);
+    std::vector<double> samples;
+    for (int rep = 0; rep < config.reps; ++rep) {
+        generateRandomInts(&data, pool, config.seed, 0, config.vectorSize);
+        QElapsedTimer timer;
+        timer.start();
+        std::sort(data.begin(), data.end());
+        samples.push_back(elapsedMs(timer));
+    }
+    return TimingStats::of(samples);
+}
+
+static void benchSort(const BenchConfig& config, QJsonArray* results) {
+    QThreadPool generatorPool;
+    TimingStats baseline = sortBaseline(config, &generatorPool);
+
+    for (int mode : config.modes) {
+        for (int threads : config.threadCounts) {
+            QThreadPool pool;
+            pool.setMaxThreadCount(threads);
+            ParallelSorter<int> sorter(&pool);
+            sorter.setCoreUtilization(config.corePercent);
+            if (config.verbose) sorter.setLogger(appendToOutput);
+
+            OverwriteVector<int> data;
+            resizeForOverwrite(&data, config.vectorSize, &pool);
+            std::vector<double> samples;
+            bool verified = true;
+            for (int rep = 0; rep < config.reps; ++rep) {
+                generateRandomInts(&data, &pool, config.seed, 0, config.vectorSize);
+                MultisetDigest before = parallelMultisetDigest(data.data(), (qint64)data.size(), &pool);
+                QElapsedTimer timer;
+                timer.start();
+                sorter.parallelSort(&data, static_cast<ParallelSorter<int>::SortMode>(mode));
+                samples.push_back(elapsedMs(timer));
+                verified = verified && parallelIsSorted(data.data(), (qint64)data.size(), &pool)
+                           && parallelMultisetDigest(data.data(), (qint64)data.size(), &pool) == before;
+            }
+
+            TimingStats stats = TimingStats::of(samples);
+            QJsonObject r;
+            r["task"] = "sort";
+            r["mode"] = modeName(mode);
+            r["threads"] = threads;
+            r["size"] = config.vectorSize;
+            r["reps"] = config.reps;
+            r["timeMs"] = stats.toJson();
+            r["baselineMs"] = baseline.toJson();
+            r["speedup"] = stats.median > 0 ? baseline.median / stats.median : 0.0;
+            r["verified"] = verified;
+            results->append(r);
+        }
+    }
+}
+
+// Generate, sort (MergeSort) and verify as one timed flow: "staged" runs
+// each step as its own pass over the vector, "pipelined" fuses them into the
+// sort's tasks with ingestRandomInts().
+static void benchIngest(const BenchConfig& config, QJsonArray* results) {
+    for (const QString& mode : QStringList{"staged", "pipelined"}) {
+        bool pipelined = mode == "pipelined";
+        for (int threads : config.threadCounts) {
+            QThreadPool pool;
+            pool.setMaxThreadCount(threads);
+            ParallelSorter<int> sorter(&pool);
+            sorter.setCoreUtilization(config.corePercent);
+            if (config.verbose) sorter.setLogger(appendToOutput);
+
+            OverwriteVector<int> data;
+            resizeForOverwrite(&data, config.vectorSize, &pool);
+            std::vector<double> samples;
+            bool verified = true;
+            for (int rep = 0; rep < config.reps; ++rep) {
+                QElapsedTimer timer;
+                timer.start();
+                if (pipelined) {
+                    SliceSortCheck<int> check;
+                    ingestRandomInts(&sorter, &data, config.seed, 0, config.vectorSize, &check);
+                    verified = check.isSorted((qint64)data.size()) && check.isPermutation() && verified;
+                } else {
+                    generateRandomInts(&data, &pool, config.seed, 0, config.vectorSize);
+                    MultisetDigest before = parallelMultisetDigest(data.data(), (qint64)data.size(), &pool);
+                    sorter.parallelSort(&data, ParallelSorter<int>::MergeSort);
+                    verified = parallelIsSorted(data.data(), (qint64)data.size(), &pool)
+                               && parallelMultisetDigest(data.data(), (qint64)data.size(), &pool) == before && verified;
+                }
+                samples.push_back(elapsedMs(timer));
+            }
+
+            QJsonObject r;
+            r["task"] = "ingest";
+            r["mode"] = mode;
+            r["threads"] = threads;
+            r["size"] = config.vectorSize;
+            r["reps"] = config.reps;
+            r["timeMs"] = TimingStats::of(samples).toJson();
+            r["verified"] = verified;
+            results->append(r);
+        }
+    }
+}
+
+// A big low-priority Task 1 sort with a small high-priority Task 3 job
+// submitted SMALL_JOB_DELAY_MS into it: "exclusive" admits one job at a
+// time, as the GUI used to, and "shared" runs both under fair-share budgets.
+// timeMs is the small job's latency, queue time plus run time.
+static void benchConcurrent(const BenchConfig& config, QJsonArray* results) {
+    const int SMALL_JOB_DELAY_MS = 20;
+    const int smallSize = std::max(1, config.decrementSize / 10);
+    for (const QString& mode : QStringList{"exclusive", "shared"}) {
+        for (int threads : config.threadCounts) {
+            QThreadPool pool;
+            pool.setMaxThreadCount(threads);
+            ParallelSorter<int> sorter(&pool);
+            OverwriteVector<int> sortData;
+            resizeForOverwrite(&sortData, config.vectorSize, &pool);
+            BoundedIntVector decrementData;
+
+            std::vector<double> latency, smallQueue, smallRun, bigRun, bigThroughput, smallThroughput;
+            bool verified = true;
+            for (int rep = 0; rep < config.reps; ++rep) {
+                JobScheduler scheduler(&pool);
+                scheduler.setMaxRunningJobs(mode == "exclusive" ? 1 : JobScheduler::DEFAULT_MAX_RUNNING_JOBS);
+                bool sorted = false;
+                bool allZero = false;
+
+                AsyncJob big("sort", [&](AsyncJob* job) {
+                    generateRandomInts(&sortData, &pool, config.seed, 0, config.vectorSize, job);
+                    sorter.parallelSort(&sortData, ParallelSorter<int>::MergeSort, job);
+                    sorted = parallelIsSorted(sortData.data(), (qint64)sortData.size(), &pool, std::less<int>(), job);
+                });
+                big.setPriority(AsyncJob::LowPriority);
+                big.setWorkSize(config.vectorSize, "elements");
+                scheduler.submit(&big);
+                QThread::msleep(SMALL_JOB_DELAY_MS);
+
+                AsyncJob small("decrement", [&](AsyncJob* job) {
+                    DecrementProcessor processor(&decrementData, &pool, smallSize, job);
+                    processor.populateVector(config.decrementMaxValue, config.seed);
+                    processor.decrementToZero();
+                    allZero = decrementData.isAllZero(&pool, job);
+                });
+                small.setPriority(AsyncJob::HighPriority);
+                small.setWorkSize(smallSize, "elements");
+                scheduler.submit(&small);
+                scheduler.waitForIdle();
+                big.wait();
+                small.wait();
+
+                latency.push_back(small.queueTimeMs() + small.runTimeMs());
+                smallQueue.push_back(small.queueTimeMs());
+                smallRun.push_back(small.runTimeMs());
+                bigRun.push_back(big.runTimeMs());
+                bigThroughput.push_back(big.throughput());
+                smallThroughput.push_back(small.throughput());
+                verified = verified && sorted && allZero;
+            }
+
+            QJsonObject r;
+            r["task"] = "concurrent";
+            r["mode"] = mode;
+            r["threads"] = threads;
+            r["size"] = config.vectorSize;
+            r["smallSize"] = smallSize;
+            r["reps"] = config.reps;
+            r["timeMs"] = TimingStats::of(latency).toJson();
+            r["smallQueueMs"] = TimingStats::of(smallQueue).toJson();
+            r["smallRunMs"] = TimingStats::of(smallRun).toJson();
+            r["bigRunMs"] = TimingStats::of(bigRun).toJson();
+            r["bigElementsPerSec"] = TimingStats::of(bigThroughput).median;
+            r["smallElementsPerSec"] = TimingStats::of(smallThroughput).median;
+            r["verified"] = verified;
+            results->append(r);
+        }
+    }
+}
+
+// One Task 2 repetition; returns false if a row came out unsorted.
+static bool runStrings(const BenchConfig& config, const QString& storage, QThreadPool* pool,
+                       std::vector<double>* populateSamples, std::vector<double>* sortSamples) {
+    QElapsedTimer timer;
+    bool verified = true;
+    if (storage == "packed") {
+        PackedStringMatrix matrix;
+        PackedStringMatrixProcessor processor(&matrix, pool, config.stringRows, config.stringCols, config.stringLength);
+        timer.start();
+        processor.populate(config.seed);
+        populateSamples->push_back(elapsedMs(timer));
+        timer.restart();
+        processor.sortRows();
+        sortSamples->push_back(elapsedMs(timer));
+        for (int row = 0; row < matrix.rows(); ++row) {
+            verified = verified && matrix.isRowSorted(row);
+        }
+    } else {
+        bool global = storage == "qstring-global";
+        std::vector<std::vector<QString>> matrix(config.stringRows);
+        StringMatrixProcessor processor(&matrix, pool, config.stringRows, config.stringCols, config.stringLength);
+        timer.start();
+        processor.populate(config.seed);
+        populateSamples->push_back(elapsedMs(timer));
+        timer.restart();
+        if (global) processor.sortGlobally();
+        else processor.sortRows();
+        sortSamples->push_back(elapsedMs(timer));
+        const QString* previous = nullptr;
+        for (const auto& row : matrix) {
+            verified = verified && (int)row.size() == config.stringCols && std::is_sorted(row.begin(), row.end());
+            if (global && !row.empty()) {
+                verified = verified && (!previous || !(row.front() < *previous));
+                previous = &row.back();
+            }
+        }
+    }
+    return verified;
+}
+
+static void benchStrings(const BenchConfig& config, QJsonArray* results) {
+    for (const QString& storage : config.stringStorages) {
+        for (int threads : config.threadCounts) {
+            QThreadPool pool;
+            pool.setMaxThreadCount(threads);
+
+            std::vector<double> populateSamples;
+            std::vector<double> sortSamples;
+            bool verified = true;
+            for (int rep = 0; rep < config.reps; ++rep) {
+                verified = runStrings(config, storage, &pool, &populateSamples, &sortSamples) && verified;
+            }
+
+            QJsonObject r;
+            r["task"] = "strings";
+            r["mode"] = storage;
+            r["threads"] = threads;
+            r["rows"] = config.stringRows;
+            r["cols"] = config.stringCols;
+            r["stringLength"] = config.stringLength;
+            r["reps"] = config.reps;
+            r["populateMs"] = TimingStats::of(populateSamples).toJson();
+            r["timeMs"] = TimingStats::of(sortSamples).toJson();
+            r["verified"] = verified;
+            results->append(r);
+        }
+    }
+}
+
+// URL-like keys with long shared prefixes, like real URL and ID columns.
+static std::vector<QString> generateUrls(int count, quint64 seed) {
+    static const char* const prefixes[] = {
+        "https://cdn.example.com/static/assets/images/",
+        "https://api.example.com/v2/accounts/",
+        "https://api.example.com/v2/accounts/orders/",
+        "urn:example:catalog:item:"
+    };
+    CounterRng rng(seed, CounterRng::StringDataStream);
+    std::vector<QString> urls((size_t)count);
+    for (int i = 0; i < count; ++i) {
+        quint64 bits = rng.at((quint64)i);
+        urls[i] = QString(prefixes[bits & 3]) + QString("%1").arg((bits >> 8) % 1000000000000ull, 12, 10, QChar('0'));
+    }
+    return urls;
+}
+
+// std::sort on one thread against ParallelStringSorter on each pool size.
+static void benchUrls(const BenchConfig& config, QJsonArray* results) {
+    const std::vector<QString> input = generateUrls(config.urlCount, config.seed);
+
+    std::vector<double> baselineSamples;
+    for (int rep = 0; rep < config.reps; ++rep) {
+        std::vector<QString> urls = input;
+        QElapsedTimer timer;
+        timer.start();
+        std::sort(urls.begin(), urls.end());
+        baselineSamples.push_back(elapsedMs(timer));
+    }
+    TimingStats baseline = TimingStats::of(baselineSamples);
+
+    for (int threads : config.threadCounts) {
+        QThreadPool pool;
+        pool.setMaxThreadCount(threads);
+        ParallelStringSorter sorter(&pool);
+        std::vector<double> samples;
+        bool verified = true;
+        for (int rep = 0; rep < config.reps; ++rep) {
+            std::vector<QString> urls = input;
+            QElapsedTimer timer;
+            timer.start();
+            sorter.sort(&urls);
+            samples.push_back(elapsedMs(timer));
+            verified = verified && urls.size() == input.size() && std::is_sorted(urls.begin(), urls.end());
+        }
+
+        TimingStats stats = TimingStats::of(samples);
+        QJsonObject r;
+        r["task"] = "urls";
+        r["mode"] = "multikey";
+        r["threads"] = threads;
+        r["size"] = config.urlCount;
+        r["reps"] = config.reps;
+        r["timeMs"] = stats.toJson();
+        r["baselineMs"] = baseline.toJson();
+        r["speedup"] = stats.median > 0 ? baseline.median / stats.median : 0.0;
+        r["verified"] = verified;
+        results->append(r);
+    }
+}
+
+static void benchDecrement(const BenchConfig& config, QJsonArray* results) {
+    for (const QString& mode : config.decrementModes) {
+        for (int threads : config.threadCounts) {
+            QThreadPool pool;
+            pool.setMaxThreadCount(threads);
+
+            std::vector<double> samples;
+            std::vector<double> passes;
+            bool verified = true;
+            BoundedIntVector data;
+            for (int rep = 0; rep < config.reps; ++rep) {
+                DecrementProcessor processor(&data, &pool, config.decrementSize);
+                processor.setMode(mode.startsWith("full") ? DecrementProcessor::FullScan : DecrementProcessor::ActiveSet);
+                processor.setExecution(mode.endsWith("-team") ? DecrementProcessor::PersistentTeam
+                                                              : DecrementProcessor::TaskContinuations);
+                processor.populateVector(config.decrementMaxValue, config.seed);
+                QElapsedTimer timer;
+                timer.start();
+                processor.decrementToZero();
+                samples.push_back(elapsedMs(timer));
+                passes.push_back(processor.passCount());
+                verified = verified && data.isAllZero(&pool);
+            }
+
+            QJsonObject r;
+            r["task"] = "decrement";
+            r["mode"] = mode;
+            r["threads"] = threads;
+            r["size"] = config.decrementSize;
+            r["maxValue"] = config.decrementMaxValue;
+            r["elementBytes"] = (int)BoundedIntVector::widthFor(config.decrementMaxValue);
+            r["reps"] = config.reps;
+            r["timeMs"] = TimingStats::of(samples).toJson();
+            r["passes"] = TimingStats::of(passes).toJson();
+            r["verified"] = verified;
+            results->append(r);
+        }
+    }
+}
+
+// Adds "scaling" (median time on 1 thread / median time) to every result
+// whose task and mode also ran on a single thread.
+static void addScaling(QJsonArray* results) {
+    for (int i = 0; i < results->size(); ++i) {
+        QJsonObject r = results->at(i).toObject();
+        for (const QJsonValue& v : *results) {
+            QJsonObject single = v.toObject();
+            if (single.value("threads").toInt() == 1 && single.value("task") == r.value("task")
+                    && single.value("mode") == r.value("mode")) {
+                double t = r.value("timeMs").toObject().value("median").toDouble();
+                if (t > 0) r["scaling"] = single.value("timeMs").toObject().value("median").toDouble() / t;
+            }
+        }
+        results->replace(i, r);
+    }
+}
+
+static bool parseIntList(const QString& text, QList<int>* out) {
+    for (const QString& part : text.split(',')) {
+        bool ok = false;
+        int value = part.trimmed().toInt(&ok);
+        if (!ok || value <= 0) return false;
+        out->append(value);
+    }
+    return !out->isEmpty();
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("parallelbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless benchmark of the parallel sort, string matrix and decrement workloads");
+    parser.addHelpOption();
+    int ideal = QThread::idealThreadCount();
+    QCommandLineOption tasksOption("tasks", "Comma-separated tasks: sort, ingest, strings, urls, decrement, concurrent.",
+                                   "list", "sort,ingest,strings,urls,decrement,concurrent");
+    QCommandLineOption modesOption("modes", "Sort engines: merge, radix, sample.", "list", "merge,radix,sample");
+    QCommandLineOption threadsOption("threads", "Comma-separated pool sizes to sweep.", "list",
+                                     ideal > 1 ? QString("1,%1").arg(ideal) : QString("1"));
+    QCommandLineOption repsOption("reps", "Repetitions per configuration.", "n", "5");
+    QCommandLineOption seedOption("seed", "Seed for generated data.", "seed", "1");
+    QCommandLineOption coreOption("core-pct", "ParallelSorter core utilization percent.", "pct", "100");
+    QCommandLineOption sizeOption("size", "Task 1 vector size (sort and ingest).", "n", QString::number(DEFAULT_VECTOR_SIZE));
+    QCommandLineOption rowsOption("rows", "Task 2 matrix rows.", "n", QString::number(DEFAULT_STRING_MATRIX_ROWS));
+    QCommandLineOption colsOption("cols", "Task 2 matrix columns.", "n", QString::number(DEFAULT_STRING_MATRIX_COLS));
+    QCommandLineOption lengthOption("string-length", "Task 2 string length.", "n", QString::number(DEFAULT_STRING_LENGTH));
+    QCommandLineOption storageOption("string-storage", "Task 2 matrix storage: packed, qstring, qstring-global.", "list",
+                                     "packed,qstring");
+    QCommandLineOption urlCountOption("url-count", "Number of URL-like strings for the urls task.", "n", "1000000");
+    QCommandLineOption decSizeOption("decrement-size", "Task 3 vector size.", "n", QString::number(DEFAULT_DECREMENT_VECTOR_SIZE));
+    QCommandLineOption decMaxOption("decrement-max", "Task 3 maximum start value.", "n", QString::number(DEFAULT_MAX_RANDOM_VALUE_DECREMENT));
+    QCommandLineOption decModeOption("decrement-mode", "Task 3 pass strategy: active, full, active-team, full-team.",
+                                     "list", "active,full,active-team,full-team");
+    QCommandLineOption outputOption("output", "Write JSON to this file instead of stdout.", "file");
+    QCommandLineOption verboseOption("verbose", "Print workload progress to stderr.");
+    QCommandLineOption traceOption("trace", "Record every task and write a Chrome trace JSON to this file.", "file");
+    QCommandLineOption pinOption("pin-workers", "Bind each pool thread to its own CPU, spread across NUMA nodes.");
+    QCommandLineOption firstTouchOption("first-touch", "Place buffer pages by parallel first touch from the workers.");
+    parser.addOptions({tasksOption, modesOption, threadsOption, repsOption, seedOption, coreOption, sizeOption,
+                       rowsOption, colsOption, lengthOption, storageOption, urlCountOption, decSizeOption, decMaxOption, decModeOption, outputOption, verboseOption,
+                       traceOption, pinOption, firstTouchOption});
+    parser.process(app);
+
+    BenchConfig config;
+    bool ok = true;
+    bool parsed = false;
+    config.tasks = parser.value(tasksOption).split(',');
+    for (const QString& mode : parser.value(modesOption).split(',')) {
+        if (mode == "merge") config.modes.append(ParallelSorter<int>::MergeSort);
+        else if (mode == "radix") config.modes.append(ParallelSorter<int>::RadixSort);
+        else if (mode == "sample") config.modes.append(ParallelSorter<int>::SampleSort);
+        else ok = false;
+    }
+    ok = ok && parseIntList(parser.value(threadsOption), &config.threadCounts);
+    config.reps = parser.value(repsOption).toInt(&parsed); ok = ok && parsed && config.reps > 0;
+    config.seed = parser.value(seedOption).toULongLong(&parsed); ok = ok && parsed;
+    config.corePercent = parser.value(coreOption).toInt(&parsed); ok = ok && parsed;
+    config.vectorSize = parser.value(sizeOption).toInt(&parsed); ok = ok && parsed;
+    config.stringRows = parser.value(rowsOption).toInt(&parsed); ok = ok && parsed;
+    config.stringCols = parser.value(colsOption).toInt(&parsed); ok = ok && parsed;
+    config.stringLength = parser.value(lengthOption).toInt(&parsed); ok = ok && parsed;
+    config.stringStorages = parser.value(storageOption).split(',');
+    for (const QString& storage : config.stringStorages) {
+        ok = ok && (storage == "packed" || storage == "qstring" || storage == "qstring-global");
+    }
+    config.urlCount = parser.value(urlCountOption).toInt(&parsed); ok = ok && parsed;
+    config.decrementSize = parser.value(decSizeOption).toInt(&parsed); ok = ok && parsed;
+    config.decrementMaxValue = parser.value(decMaxOption).toInt(&parsed); ok = ok && parsed;
+    config.decrementModes = parser.value(decModeOption).split(',');
+    for (const QString& mode : config.decrementModes) {
+        ok = ok && (mode == "active" || mode == "full" || mode == "active-team" || mode == "full-team");
+    }
+    config.verbose = parser.isSet(verboseOption);
+    if (!ok) {
+        fprintf(stderr, "Invalid option value.\n\n");
+        parser.showHelp(1);
+    }
+
+    if (config.verbose) {
+        setOutputSink([](const QString& text) { fprintf(stderr, "%s\n", qPrintable(text)); });
+    }
+    TaskTrace::setEnabled(parser.isSet(traceOption));
+    NumaPlacement::setPinWorkers(parser.isSet(pinOption));
+    NumaPlacement::setFirstTouch(parser.isSet(firstTouchOption));
+
+    QJsonArray results;
+    for (const QString& task : config.tasks) {
+        fprintf(stderr, "Running %s...\n", qPrintable(task));
+        if (task == "sort") benchSort(config, &results);
+        else if (task == "ingest") benchIngest(config, &results);
+        else if (task == "strings") benchStrings(config, &results);
+        else if (task == "urls") benchUrls(config, &results);
+        else if (task == "decrement") benchDecrement(config, &results);
+        else if (task == "concurrent") benchConcurrent(config, &results);
+        else fprintf(stderr, "Unknown task '%s' skipped.\n", qPrintable(task));
+    }
+    addScaling(&results);
+
+    if (parser.isSet(traceOption)) {
+        TaskTrace::setEnabled(false);
+        if (!TaskTrace::writeChromeJson(parser.value(traceOption))) {
+            fprintf(stderr, "Cannot write %s\n", qPrintable(parser.value(traceOption)));
+            return 1;
+        }
+        fprintf(stderr, "Trace: %lld tasks, %lld dropped\n", (long long)TaskTrace::eventCount(), (long long)TaskTrace::droppedCount());
+    }
+
+    QJsonObject root;
+    root["seed"] = QString::number(config.seed); // JSON numbers cannot hold every quint64
+    root["idealThreadCount"] = ideal;
+    root["cpu"] = QSysInfo::currentCpuArchitecture();
+    root["intSortKernels"] = simdLevelName(simdLevel());
+    root["corePercent"] = config.corePercent;
+    root["numaNodes"] = NumaPlacement::numaNodeCount();
+    root["pinWorkers"] = NumaPlacement::pinWorkers();
+    root["firstTouch"] = NumaPlacement::firstTouch();
+    root["results"] = results;
+    QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+            fprintf(stderr, "Cannot write %s\n", qPrintable(parser.value(outputOption)));
+            return 1;
+        }
+    } else {
+        fwrite(json.constData(), 1, json.size(), stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#include "boundedvector.h"
+#include "parallelverify.h"
+
+BoundedIntVector::Width BoundedIntVector::widthFor(int maxValue) {
+    if (maxValue <= 0xFF) return Width8;
+    if (maxValue <= 0xFFFF) return Width16;
+    return Width32;
+}
+
+const char* BoundedIntVector::widthName(Width width) {
+    switch (width) {
+    case Width8: return "8-bit";
+    case Width16: return "16-bit";
+    default: return "32-bit";
+    }
+}
+
+void BoundedIntVector::reset(qint64 size, int maxValue, QThreadPool* pool, AsyncJob* job) {
+    m_width = widthFor(maxValue);
+    m_size = size;
+    resizeForOverwrite(&m_bytes, (size_t)(size * m_width), pool, job);
+}
+
+int BoundedIntVector::at(qint64 i) const {
+    switch (m_width) {
+    case Width8: return data<quint8>()[i];
+    case Width16: return data<quint16>()[i];
+    default: return data<int>()[i];
+    }
+}
+
+bool BoundedIntVector::isAllZero(QThreadPool* pool, AsyncJob* job) const {
+    switch (m_width) {
+    case Width8: return parallelAllOf(data<quint8>(), m_size, pool, [](quint8 v) { return v == 0; }, job);
+    case Width16: return parallelAllOf(data<quint16>(), m_size, pool, [](quint16 v) { return v == 0; }, job);
+    default: return parallelAllOf(data<int>(), m_size, pool, [](int v) { return v == 0; }, job);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef BOUNDEDVECTOR_H
+#define BOUNDEDVECTOR_H
+
+#include "overwritevector.h"
+#include <QtGlobal>
+
+class AsyncJob;
+class QThreadPool;
+
+// Non-negative ints stored at the narrowest width that holds their range:
+// quint8 up to 255, quint16 up to 65535, int beyond. A pass over Task 3's
+// values (at most 50) then streams one byte per element instead of four.
+//
+// Kernels are templates over the element type; callers switch on width()
+// once per call and take typed pointers with data<T>(), so each width gets
+// its own compiled loop rather than a per-element branch.
+class BoundedIntVector
+{
+public:
+    enum Width {
+        Width8 = 1,
+        Width16 = 2,
+        Width32 = 4
+    };
+
+    static Width widthFor(int maxValue);
+    static const char* widthName(Width width);
+
+    BoundedIntVector() : m_width(Width32), m_size(0) {}
+
+    // Resizes to 'size' values in [0, maxValue]; the contents are
+    // unspecified (see resizeForOverwrite() for the first-touch behaviour).
+    void reset(qint64 size, int maxValue, QThreadPool* pool, AsyncJob* job = nullptr);
+
+    Width width() const { return m_width; }
+    qint64 size() const { return m_size; }
+    qint64 byteSize() const { return m_size * m_width; }
+
+    // T must match width(): quint8, quint16 or int.
+    template <typename T> T* data() { return reinterpret_cast<T*>(m_bytes.data()); }
+    template <typename T> const T* data() const { return reinterpret_cast<const T*>(m_bytes.data()); }
+
+    int at(qint64 i) const;
+    bool isAllZero(QThreadPool* pool, AsyncJob* job = nullptr) const;
+
+private:
+    Width m_width;
+    qint64 m_size;
+    OverwriteVector<quint8> m_bytes;
+};
+
+#endif // BOUNDEDVECTOR_H
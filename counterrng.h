@@ -0,0 +1,116 @@
+#ifndef COUNTERRNG_H
+#define COUNTERRNG_H
+
+#include <QtGlobal>
+
+// Counter-based random numbers: the value for element i is a pure function
+// of (seed, stream, i), computed as SplitMix64 at position i. There is no
+// generator state to seed or carry between elements, so
+//
+//   - any thread can generate any index range without setup cost,
+//   - output is bit-identical for every thread count and chunking, and
+//   - a run is reproduced exactly from its seed.
+//
+// Fill loops have no loop-carried dependency and vectorize.
+
+// 64-bit finalizer from SplitMix64: every input bit affects every output bit.
+inline quint64 mixBits64(quint64 x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+class CounterRng
+{
+public:
+    // Independent streams per consumer, so data drawn for different purposes
+    // from one seed is uncorrelated.
+    enum Stream {
+        SortDataStream = 1,
+        DecrementDataStream = 2,
+        StringDataStream = 3,
+        DecrementCoinStream = 4
+    };
+
+    CounterRng(quint64 seed, quint64 stream)
+        : m_key(mixBits64(seed ^ mixBits64(stream + GOLDEN_GAMMA))) {}
+
+    quint64 at(quint64 index) const {
+        return mixBits64(m_key + index * GOLDEN_GAMMA);
+    }
+
+    // Uniform in [minValue, maxValue], from the top 32 bits by multiply-shift
+    // (bias below 2^-32 relative for the ranges used here).
+    int boundedAt(quint64 index, int minValue, int maxValue) const {
+        quint64 range = (quint64)((qint64)maxValue - minValue + 1);
+        return minValue + (int)(((at(index) >> 32) * range) >> 32);
+    }
+
+    // out[i] = boundedAt(firstIndex + i, minValue, maxValue) for i in [0, count)
+    void fillInts(int* out, qint64 count, quint64 firstIndex, int minValue, int maxValue) const {
+        fillBounded(out, count, firstIndex, minValue, maxValue);
+    }
+
+    // The same values stored as T, which must hold [minValue, maxValue].
+    template <typename T>
+    void fillBounded(T* out, qint64 count, quint64 firstIndex, int minValue, int maxValue) const {
+        const quint64 range = (quint64)((qint64)maxValue - minValue + 1);
+        const quint64 base = m_key + firstIndex * GOLDEN_GAMMA;
+        for (qint64 i = 0; i < count; ++i) {
+            quint64 bits = mixBits64(base + (quint64)i * GOLDEN_GAMMA);
+            out[i] = (T)(minValue + (int)(((bits >> 32) * range) >> 32));
+        }
+    }
+
+    // Characters per draw in fillChars(): three from each 32-bit half.
+    static const int CHARS_PER_DRAW = 6;
+
+    // out[i] = alphabet[uniform in [0, alphabetSize)] for character index
+    // firstChar + i. Character c is slot c % CHARS_PER_DRAW of draw
+    // c / CHARS_PER_DRAW, so any split of a range fills the same bytes.
+    //
+    // Each half of a draw is a 32-bit fraction; multiplying it by the
+    // alphabet size yields a character in the high word and the unused
+    // fraction in the low word for the next one. Three characters per half
+    // leave at least 32 - 2 * log2(alphabetSize) bits for the last one, so
+    // it is off uniform by under 2^-14 relative with 62 characters.
+    void fillChars(char* out, qint64 count, quint64 firstChar, const char* alphabet, int alphabetSize) const {
+        quint64 draw = firstChar / CHARS_PER_DRAW;
+        int skip = (int)(firstChar % CHARS_PER_DRAW);
+        char chars[CHARS_PER_DRAW];
+        qint64 i = 0;
+        if (skip > 0) { // Range starts inside a draw
+            drawChars(draw++, alphabet, alphabetSize, chars);
+            for (int k = skip; k < CHARS_PER_DRAW && i < count; ++k) out[i++] = chars[k];
+        }
+        for (; i + CHARS_PER_DRAW <= count; i += CHARS_PER_DRAW) {
+            drawChars(draw++, alphabet, alphabetSize, out + i);
+        }
+        if (i < count) {
+            drawChars(draw, alphabet, alphabetSize, chars);
+            for (int k = 0; i < count; ++k) out[i++] = chars[k];
+        }
+    }
+
+private:
+    void drawChars(quint64 draw, const char* alphabet, int alphabetSize, char* out) const {
+        quint64 bits = at(draw);
+        quint32 halves[2] = {(quint32)bits, (quint32)(bits >> 32)};
+        for (int h = 0; h < 2; ++h) {
+            quint32 fraction = halves[h];
+            for (int k = 0; k < CHARS_PER_DRAW / 2; ++k) {
+                quint64 scaled = (quint64)fraction * (quint32)alphabetSize;
+                out[h * (CHARS_PER_DRAW / 2) + k] = alphabet[scaled >> 32];
+                fraction = (quint32)scaled;
+            }
+        }
+    }
+
+    static const quint64 GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+    quint64 m_key;
+};
+
+#endif // COUNTERRNG_H
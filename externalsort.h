@@ -0,0 +1,218 @@
+#ifndef EXTERNALSORT_H
+#define EXTERNALSORT_H
+
+#include "asyncjob.h"
+#include "parallelfor.h"
+#include "parallelsort.h"
+#include "taskgraph.h"
+#include <QAtomicInt>
+#include <QDir>
+#include <QFile>
+#include <QString>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QtGlobal>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Out-of-core sorting of a flat binary file of T records (native byte order)
+// that does not fit in memory.
+//
+//   1. Run formation - the input is memory-mapped one block at a time, copied
+//      into RAM in parallel, sorted with ParallelSorter and spilled to a run
+//      file in a temporary directory. A block plus the sorter's scratch buffer
+//      stay within the memory budget.
+//   2. Merge - all runs are mapped read-only and the output file is cut into
+//      one slice per pool thread. Each slice is located in every run by
+//      co-ranking, then merged window by window into a private buffer that is
+//      written with one large sequential write, so the tasks never coordinate.
+//
+// The page cache does the reading for both phases; the kernel is asked for
+// sequential read-ahead on every mapping where the platform supports it.
+template <typename T, typename Compare = std::less<T>>
+class ExternalSorter {
+    static_assert(std::is_trivially_copyable<T>::value, "ExternalSorter stores records as raw bytes");
+
+public:
+    explicit ExternalSorter(QThreadPool* pool, qint64 memoryBudgetBytes, Compare comp = Compare())
+        : m_pool(pool), m_memoryBudget(memoryBudgetBytes), m_comp(comp), m_tempPath(QDir::tempPath()) {}
+
+    void setLogger(SortLogger logger) { m_log = logger; }
+    void setTempPath(const QString& path) { m_tempPath = path; }
+    QString errorString() const { return m_error; }
+
+    // Returns false on I/O errors (see errorString()) and on cancellation.
+    bool sortFile(const QString& inputPath, const QString& outputPath, AsyncJob* job = nullptr) {
+        m_error.clear();
+        if (m_pool->maxThreadCount() == 0) return fail("Thread pool has 0 max threads. Cannot sort.");
+
+        QFile input(inputPath);
+        if (!input.open(QIODevice::ReadOnly)) return fail(QString("Cannot open %1: %2").arg(inputPath, input.errorString()));
+        if (input.size() % sizeof(T) != 0) return fail(QString("%1 is not a whole number of records").arg(inputPath));
+        qint64 total = input.size() / sizeof(T);
+
+        QTemporaryDir runDir(QDir(m_tempPath).filePath("extsort-XXXXXX"));
+        if (!runDir.isValid()) return fail(QString("Cannot create a run directory under %1").arg(m_tempPath));
+
+        std::vector<QString> runPaths;
+        if (!formRuns(input, total, runDir, runPaths, job)) return false;
+        input.close();
+        return mergeRuns(runPaths, total, outputPath, job);
+    }
+
+private:
+    static const qint64 MERGE_WINDOW_BYTES = 4 * 1024 * 1024; // Per-task output buffer, one write() each
+
+    QThreadPool* m_pool;
+    qint64 m_memoryBudget;
+    Compare m_comp;
+    QString m_tempPath;
+    QString m_error;
+    SortLogger m_log;
+
+    void message(const QString& text) const {
+        if (m_log) m_log(text);
+    }
+
+    bool fail(const QString& error) {
+        m_error = error;
+        message("External sort failed: " + error);
+        return false;
+    }
+
+    static bool cancelled(AsyncJob* job) { return job && job->isCancelled(); }
+
+    static void adviseSequential(const void* addr, qint64 bytes) {
+#ifdef Q_OS_UNIX
+        // posix_madvise wants a page-aligned start; QFile::map() only
+        // guarantees that for offset 0.
+        quintptr page = (quintptr)sysconf(_SC_PAGESIZE);
+        quintptr start = (quintptr)addr & ~(page - 1);
+        qint64 length = bytes + (qint64)((quintptr)addr - start);
+        posix_madvise((void*)start, (size_t)length, POSIX_MADV_SEQUENTIAL);
+        posix_madvise((void*)start, (size_t)length, POSIX_MADV_WILLNEED);
+#else
+        Q_UNUSED(addr);
+        Q_UNUSED(bytes);
+#endif
+    }
+
+    bool formRuns(QFile& input, qint64 total, const QTemporaryDir& runDir, std::vector<QString>& runPaths, AsyncJob* job) {
+        // The block and the sorter's equally sized scratch buffer share the budget.
+        qint64 blockElements = std::max<qint64>(1, m_memoryBudget / (2 * (qint64)sizeof(T)));
+        qint64 numRuns = (total + blockElements - 1) / blockElements;
+        message(QString("External sort: %1 records, %2 MB budget, %3 runs of up to %4 records")
+                .arg(total).arg(m_memoryBudget / (1024 * 1024)).arg(numRuns).arg(blockElements));
+
+        ParallelSorter<T, Compare> sorter(m_pool, m_comp);
+        typename ParallelSorter<T, Compare>::SortMode mode = ParallelSorter<T, Compare>::supportsRadix()
+                ? ParallelSorter<T, Compare>::RadixSort : ParallelSorter<T, Compare>::MergeSort;
+        OverwriteVector<T> block;
+
+        for (qint64 run = 0; run < numRuns; ++run) {
+            if (job) job->beginPhase(QString("Forming run %1 of %2").arg(run + 1).arg(numRuns));
+            qint64 first = run * blockElements;
+            qint64 count = std::min(blockElements, total - first);
+            qint64 bytes = count * (qint64)sizeof(T);
+
+            uchar* mapped = input.map(first * (qint64)sizeof(T), bytes);
+            if (!mapped) return fail(QString("Cannot map %1: %2").arg(input.fileName(), input.errorString()));
+            adviseSequential(mapped, bytes);
+
+            // Copy in parallel so the page faults of the read are spread over the pool.
+            block.resize(count);
+            // No job here: progress in this phase counts runs, not blocks.
+            T* dst = block.data();
+            parallelFor(m_pool, 0, count, Grain::automatic(MIN_ELEMENT_GRAIN), [dst, mapped](qint64 first, qint64 end) {
+                std::memcpy(dst + first, mapped + first * sizeof(T), (end - first) * sizeof(T));
+            }, nullptr, "External run block copy");
+            input.unmap(mapped);
+            if (cancelled(job)) return false;
+
+            sorter.parallelSort(&block, mode, job);
+            if (cancelled(job)) return false;
+
+            QString path = runDir.filePath(QString("run-%1.bin").arg(run));
+            QFile out(path);
+            if (!out.open(QIODevice::WriteOnly) || out.write((const char*)block.data(), bytes) != bytes) {
+                return fail(QString("Cannot write run %1: %2").arg(path, out.errorString()));
+            }
+            runPaths.push_back(path);
+            if (job) job->updateProgress(run + 1, numRuns);
+        }
+        return true;
+    }
+
+    bool mergeRuns(const std::vector<QString>& runPaths, qint64 total, const QString& outputPath, AsyncJob* job) {
+        if (job) job->beginPhase(QString("Merging %1 runs").arg(runPaths.size()));
+        message(QString("External sort: merging %1 runs into %2").arg(runPaths.size()).arg(outputPath));
+
+        QFile output(outputPath);
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate) || !output.resize(total * (qint64)sizeof(T))) {
+            return fail(QString("Cannot create %1: %2").arg(outputPath, output.errorString()));
+        }
+        output.close();
+
+        std::vector<QFile*> runFiles;
+        std::vector<SortedRun<T>> runs;
+        bool ok = true;
+        for (const QString& path : runPaths) {
+            QFile* file = new QFile(path);
+            runFiles.push_back(file);
+            uchar* mapped = file->open(QIODevice::ReadOnly) ? file->map(0, file->size()) : nullptr;
+            if (!mapped) {
+                ok = fail(QString("Cannot map run %1: %2").arg(path, file->errorString()));
+                break;
+            }
+            adviseSequential(mapped, file->size());
+            const T* begin = reinterpret_cast<const T*>(mapped);
+            runs.push_back({begin, begin + file->size() / (qint64)sizeof(T)});
+        }
+
+        QAtomicInt writeErrors(0);
+        if (ok) {
+            TaskGraph graph(m_pool, job);
+            RunList slices = chunkRanges(total, m_pool->maxThreadCount());
+            for (const auto& s : slices) {
+                graph.add([this, &runs, &outputPath, &writeErrors, s, job]() {
+                    if (!mergeSlice(runs, s.first, s.second, outputPath, job)) writeErrors.ref();
+                }, std::vector<TaskGraph::NodeId>(), "External merge slice");
+            }
+            graph.wait();
+            if (writeErrors.load() > 0) ok = fail(QString("Writing %1 failed").arg(outputPath));
+        }
+
+        for (QFile* file : runFiles) delete file; // Also unmaps
+        return ok && !cancelled(job);
+    }
+
+    // Merges output records [outStart, outEnd) from all runs into the output
+    // file, MERGE_WINDOW_BYTES at a time.
+    bool mergeSlice(const std::vector<SortedRun<T>>& runs, qint64 outStart, qint64 outEnd,
+                    const QString& outputPath, AsyncJob* job) const {
+        QFile out(outputPath);
+        if (!out.open(QIODevice::ReadWrite) || !out.seek(outStart * (qint64)sizeof(T))) return false;
+
+        qint64 windowElements = std::max<qint64>(1, MERGE_WINDOW_BYTES / (qint64)sizeof(T));
+        std::vector<T> window((size_t)std::min(windowElements, outEnd - outStart));
+        std::vector<qint64> cursor = coRank(runs, outStart, m_comp);
+        for (qint64 pos = outStart; pos < outEnd; pos += windowElements) {
+            if (cancelled(job)) return true;
+            qint64 end = std::min(pos + windowElements, outEnd);
+            std::vector<qint64> limit = coRank(runs, end, m_comp);
+            kWayMerge(runs, cursor, limit, m_comp, window.data());
+            qint64 bytes = (end - pos) * (qint64)sizeof(T);
+            if (out.write((const char*)window.data(), bytes) != bytes) return false;
+            cursor.swap(limit);
+        }
+        return true;
+    }
+};
+
+#endif // EXTERNALSORT_H
@@ -0,0 +1,108 @@
+#include "jobscheduler.h"
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <algorithm>
+
+JobScheduler::JobScheduler(QThreadPool* pool)
+    : m_pool(pool), m_maxRunning(DEFAULT_MAX_RUNNING_JOBS) {}
+
+JobScheduler::~JobScheduler() {
+    cancelAll();
+    waitForIdle();
+}
+
+void JobScheduler::setMaxRunningJobs(int jobs) {
+    QMutexLocker locker(&m_mutex);
+    m_maxRunning = std::max(1, jobs);
+    startAdmissibleJobs();
+}
+
+int JobScheduler::maxRunningJobs() const {
+    QMutexLocker locker(&m_mutex);
+    return m_maxRunning;
+}
+
+void JobScheduler::submit(AsyncJob* job, const QString& resource) {
+    job->setFinishHandler([this](AsyncJob* finished) { jobFinished(finished); });
+    QMutexLocker locker(&m_mutex);
+    m_queued.push_back(Entry{job, resource});
+    startAdmissibleJobs();
+}
+
+void JobScheduler::cancelAll() {
+    QMutexLocker locker(&m_mutex);
+    for (const Entry& entry : m_running) entry.job->cancel();
+    for (const Entry& entry : m_queued) entry.job->cancel();
+}
+
+int JobScheduler::runningJobs() const {
+    QMutexLocker locker(&m_mutex);
+    return (int)m_running.size();
+}
+
+int JobScheduler::queuedJobs() const {
+    QMutexLocker locker(&m_mutex);
+    return (int)m_queued.size();
+}
+
+void JobScheduler::waitForIdle() {
+    QMutexLocker locker(&m_mutex);
+    while (!m_running.empty() || !m_queued.empty()) {
+        m_idle.wait(&m_mutex);
+    }
+}
+
+int JobScheduler::weight(AsyncJob::Priority priority) {
+    return 1 << (priority - AsyncJob::LowPriority);
+}
+
+// Runs on the finished job's driver thread, after its body.
+void JobScheduler::jobFinished(AsyncJob* job) {
+    QMutexLocker locker(&m_mutex);
+    m_running.erase(std::remove_if(m_running.begin(), m_running.end(),
+                                   [job](const Entry& entry) { return entry.job == job; }),
+                    m_running.end());
+    startAdmissibleJobs();
+    if (m_running.empty() && m_queued.empty()) m_idle.wakeAll();
+}
+
+void JobScheduler::startAdmissibleJobs() {
+    // Highest priority first; stable, so submission order breaks ties.
+    std::stable_sort(m_queued.begin(), m_queued.end(), [](const Entry& a, const Entry& b) {
+        return a.job->priority() > b.job->priority();
+    });
+    std::vector<Entry> started;
+    for (auto it = m_queued.begin(); it != m_queued.end() && (int)m_running.size() < m_maxRunning;) {
+        if (resourceBusy(it->resource)) {
+            ++it;
+            continue;
+        }
+        m_running.push_back(*it);
+        started.push_back(*it);
+        it = m_queued.erase(it);
+    }
+    rebalance(); // Before the new jobs start, so their first loops see their share
+    for (const Entry& entry : started) entry.job->start();
+}
+
+void JobScheduler::rebalance() {
+    if (m_running.size() == 1) {
+        m_running[0].job->setThreadShare(0); // Alone: the whole pool
+        return;
+    }
+    int totalWeight = 0;
+    for (const Entry& entry : m_running) totalWeight += weight(entry.job->priority());
+    const int threads = m_pool->maxThreadCount();
+    for (const Entry& entry : m_running) {
+        int share = (threads * weight(entry.job->priority()) + totalWeight / 2) / std::max(1, totalWeight);
+        entry.job->setThreadShare(std::max(1, share));
+    }
+}
+
+bool JobScheduler::resourceBusy(const QString& resource) const {
+    if (resource.isEmpty()) return false;
+    for (const Entry& entry : m_running) {
+        if (entry.resource == resource) return true;
+    }
+    return false;
+}
@@ -0,0 +1,79 @@
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include "asyncjob.h"
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <vector>
+
+class QThreadPool;
+
+// Admits several AsyncJobs onto one shared pool at a time.
+//
+// Queued jobs start in priority order, first come first served within a
+// priority, as long as fewer than maxRunningJobs() are running. A job that
+// names a resource (a buffer its body uses, say) waits while another job
+// holding the same resource runs; jobs behind it may start first.
+//
+// Running jobs split the pool by weight: 1 for low, 2 for normal and 4 for
+// high priority, and at least one thread each. The shares are recomputed
+// whenever a job starts or finishes and published through
+// AsyncJob::setThreadShare(), which TaskGraph, parallelFor() and worker
+// teams follow.
+// Together with the pool queue ordering nodes by job priority, a small
+// high-priority job gets threads within a block or two of a big job's loop
+// instead of after its last phase.
+//
+// Thread-safe; finishing jobs are handled on their own driver threads, so no
+// event loop is needed.
+class JobScheduler
+{
+public:
+    static const int DEFAULT_MAX_RUNNING_JOBS = 4;
+
+    explicit JobScheduler(QThreadPool* pool);
+    ~JobScheduler(); // Cancels every job and waits until none is running
+
+    void setMaxRunningJobs(int jobs);
+    int maxRunningJobs() const;
+
+    // Queues 'job', which must not have been started and must outlive its
+    // finished() signal; the scheduler does not take ownership. Replaces the
+    // job's finish handler.
+    void submit(AsyncJob* job, const QString& resource = QString());
+
+    // Cancels running and queued jobs. Queued ones still start, in turn,
+    // but return at once (see AsyncJob).
+    void cancelAll();
+
+    int runningJobs() const;
+    int queuedJobs() const;
+
+    // Blocks until no job is queued or running.
+    void waitForIdle();
+
+private:
+    struct Entry {
+        AsyncJob* job;
+        QString resource;
+    };
+
+    static int weight(AsyncJob::Priority priority);
+
+    void jobFinished(AsyncJob* job);
+    void startAdmissibleJobs(); // Called with m_mutex held
+    void rebalance();           // Called with m_mutex held
+    bool resourceBusy(const QString& resource) const; // Called with m_mutex held
+
+    QThreadPool* m_pool;
+    int m_maxRunning;
+    mutable QMutex m_mutex;
+    QWaitCondition m_idle;
+    std::vector<Entry> m_queued;  // In submission order
+    std::vector<Entry> m_running;
+
+    Q_DISABLE_COPY(JobScheduler)
+};
+
+#endif // JOBSCHEDULER_H
@@ -0,0 +1,48 @@
+#include "logring.h"
+
+LogRing::LogRing(int capacity) : m_enqueuePos(0), m_dequeuePos(0), m_dropped(0) {
+    quint64 size = 2;
+    while (size < (quint64)capacity) size <<= 1;
+    m_slots.reset(new Slot[size]);
+    m_mask = size - 1;
+    for (quint64 i = 0; i < size; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool LogRing::push(const QString& text) {
+    quint64 pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &m_slots[pos & m_mask];
+        quint64 sequence = slot->sequence.load(std::memory_order_acquire);
+        qint64 diff = (qint64)(sequence - pos);
+        if (diff == 0) {
+            // Slot is free for this position; claim it
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            // The consumer has not emptied it since the last lap: full
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed); // Another producer won it
+        }
+    }
+    slot->text = text; // Implicitly shared: no copy of the characters
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+int LogRing::drain(QStringList* out, int maxLines) {
+    int count = 0;
+    while (count < maxLines) {
+        Slot& slot = m_slots[m_dequeuePos & m_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) break; // Not yet published
+        out->append(slot.text);
+        slot.text = QString();
+        slot.sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release); // Free for the next lap
+        ++m_dequeuePos;
+        ++count;
+    }
+    return count;
+}
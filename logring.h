@@ -0,0 +1,49 @@
+#ifndef LOGRING_H
+#define LOGRING_H
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+// Bounded lock-free queue of log lines: any number of producer threads, one
+// consumer that drains in batches (the GUI thread, on a timer).
+//
+// Each slot carries a sequence number that says whose turn it is, so a
+// producer claims a slot with one CAS on the enqueue position and publishes
+// it with one release store; the consumer needs no atomics of its own. When
+// the ring is full, push() drops the line and counts it instead of blocking
+// a worker.
+class LogRing
+{
+public:
+    explicit LogRing(int capacity); // Rounded up to a power of two
+
+    bool push(const QString& text);
+
+    // Consumer only: moves up to maxLines queued lines into *out, oldest
+    // first, and returns how many.
+    int drain(QStringList* out, int maxLines);
+
+    // Lines dropped since the last call.
+    quint64 takeDropped() { return m_dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<quint64> sequence;
+        QString text;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    quint64 m_mask;
+    char m_padProducer[64]; // Keep the producers' counter off the consumer's line
+    std::atomic<quint64> m_enqueuePos;
+    char m_padConsumer[64];
+    quint64 m_dequeuePos;
+    std::atomic<quint64> m_dropped;
+
+    Q_DISABLE_COPY(LogRing)
+};
+
+#endif // LOGRING_H
@@ -1,11 +1,39 @@
 // === main.cpp ===
 #include "mainwindow.h"
 #include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Parallel sorting and processing demos on a shared thread pool");
+    parser.addHelpOption();
+    QCommandLineOption seedOption("seed", "Seed for generated data; the same seed reproduces the same inputs.", "seed");
+    parser.addOption(seedOption);
+    QCommandLineOption traceOption("trace", "Write a Chrome trace JSON of every task to this file after each job.", "file");
+    parser.addOption(traceOption);
+    QCommandLineOption pinOption("pin-workers", "Bind each pool thread to its own CPU, spread across NUMA nodes.");
+    parser.addOption(pinOption);
+    QCommandLineOption firstTouchOption("first-touch", "Place buffer pages by parallel first touch from the workers that use them.");
+    parser.addOption(firstTouchOption);
+    parser.process(a);
+
     MainWindow w;
+    if (parser.isSet(seedOption)) {
+        bool ok = false;
+        quint64 seed = parser.value(seedOption).toULongLong(&ok);
+        if (!ok) {
+            parser.showHelp(1);
+        }
+        w.setRandomSeed(seed);
+    }
+    if (parser.isSet(traceOption)) {
+        w.setTraceFile(parser.value(traceOption));
+    }
+    w.setNumaPlacement(parser.isSet(pinOption), parser.isSet(firstTouchOption));
     w.show();
     return a.exec();
 }
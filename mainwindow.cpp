@@ -1,22 +1,36 @@
 #include "mainwindow.h"
+#include "taskgraph.h"
+#include "asyncjob.h"
+#include "parallelsort.h"
+#include "externalsort.h"
+#include "jobscheduler.h"
+#include "simdsort.h"
+#include "parallelverify.h"
+#include "workloads.h"
+#include "outputlog.h"
+#include "logring.h"
+#include "numaplacement.h"
+#include "tasktrace.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QPushButton>
+#include <QComboBox>
+#include <QProgressBar>
 #include <QTextEdit>
+#include <QTimer>
+#include <QFile>
+#include <QTemporaryDir>
 #include <QThreadPool>
 #include <QRunnable>
 #include <QThread>
 #include <QElapsedTimer>
-#include <QMutex>
-#include <QMutexLocker>
 #include <QMetaObject>
-#include <QApplication>
 #include <QRandomGenerator>
 #include <QVector> // Added for QVector
 // QAtomicInt is typically included via QtCore/qatomic.h or QtCore/qglobal.h
 #include <algorithm>
-#include <random> // For std::mt19937
+#include <numeric>
 #include <atomic> // For std::atomic (though one use case is replaced)
 #include <iostream>
 #include <iomanip>
@@ -24,522 +38,134 @@
 #include <chrono>
 #include <functional>
 
-// Global pointer to main window for output
-MainWindow* g_mainWindow = nullptr;
-
-// Helper function to append text to the main window (thread-safe)
-void appendToOutput(const QString& text) {
-    if (g_mainWindow) {
-        g_mainWindow->appendOutput(text);
-    }
-}
-
-// === Task 1: Original Parallel Sort (Refactored to use shared pool) ===
-
-class RandomGenTask : public QRunnable {
-private:
-    std::vector<int>* data;
-    int startIndex;
-    int endIndex;
-    int maxValue;
-
-public:
-    RandomGenTask(std::vector<int>* vec, int start, int end, int maxVal = MainWindow::VECTOR_SIZE)
-        : data(vec), startIndex(start), endIndex(end), maxValue(maxVal) {
-        setAutoDelete(true);
-    }
-
-    void run() override {
-        std::random_device rd;
-        std::mt19937 gen(rd() ^ ( (std::mt19937::result_type)
-                                 std::chrono::duration_cast<std::chrono::seconds>(
-                                     std::chrono::system_clock::now().time_since_epoch()
-                                 ).count() +
-                                 (std::mt19937::result_type)
-                                 std::hash<std::thread::id>()(std::this_thread::get_id()) ) );
-        std::uniform_int_distribution<> dis(1, maxValue);
-
-        for (int i = startIndex; i < endIndex; i++) {
-            (*data)[i] = dis(gen);
-        }
-    }
-};
-
-class SortTask : public QRunnable {
-private:
-    std::vector<int>* data;
-    int startIndex;
-    int endIndex;
-    int taskId;
-
-public:
-    SortTask(std::vector<int>* vec, int start, int end, int id)
-        : data(vec), startIndex(start), endIndex(end), taskId(id) {
-        setAutoDelete(true);
-    }
-
-    void run() override {
-        QString startMsg = QString("[Thread %1] Task %2 sorting range [%3-%4)")
-                          .arg((quintptr)QThread::currentThreadId())
-                          .arg(taskId)
-                          .arg(startIndex)
-                          .arg(endIndex);
-        appendToOutput(startMsg);
-
-        std::sort(data->begin() + startIndex, data->begin() + endIndex);
-        if (MainWindow::USE_PCT_CORE < 100) {
-            int delayMs = (100 - MainWindow::USE_PCT_CORE) * 2;
-            QThread::msleep(delayMs);
-        }
-
-        QString endMsg = QString("[Thread %1] Task %2 completed sorting")
-                        .arg((quintptr)QThread::currentThreadId())
-                        .arg(taskId);
-        appendToOutput(endMsg);
-    }
-};
-
-class MergeTask : public QRunnable {
-private:
-    std::vector<int>* data;
-    int start1, end1;
-    int start2, end2;
-    int taskId;
-
-public:
-    MergeTask(std::vector<int>* vec, int s1, int e1, int s2, int e2, int id)
-        : data(vec), start1(s1), end1(e1), start2(s2), end2(e2), taskId(id) {
-        setAutoDelete(true);
-    }
-
-    void run() override {
-        QString startMsg = QString("[Thread %1] Merge Task %2 merging ranges [%3-%4) and [%5-%6)")
-                          .arg((quintptr)QThread::currentThreadId())
-                          .arg(taskId)
-                          .arg(start1)
-                          .arg(end1)
-                          .arg(start2)
-                          .arg(end2);
-        appendToOutput(startMsg);
-
-        std::vector<int> temp;
-        temp.reserve((end1 - start1) + (end2 - start2));
-        std::merge(data->begin() + start1, data->begin() + end1,
-                   data->begin() + start2, data->begin() + end2,
-                   std::back_inserter(temp));
-        std::copy(temp.begin(), temp.end(), data->begin() + start1);
-        if (MainWindow::USE_PCT_CORE < 100) {
-            int delayMs = (100 - MainWindow::USE_PCT_CORE) * 2;
-            QThread::msleep(delayMs);
-        }
-
-        QString endMsg = QString("[Thread %1] Merge Task %2 completed")
-                        .arg((quintptr)QThread::currentThreadId())
-                        .arg(taskId);
-        appendToOutput(endMsg);
-    }
-};
-
-class ParallelSorter {
-private:
-    QThreadPool* m_pool;    // Declared first
-    std::vector<int>* data; // Declared second
-public:
-    // Initializer list order matches declaration order
-    ParallelSorter(std::vector<int>* vec, QThreadPool* pool) : m_pool(pool), data(vec) {
-        appendToOutput(QString("ParallelSorter using shared pool with max %1 threads.").arg(m_pool->maxThreadCount()));
-        appendToOutput(QString("Core utilization set to %1%").arg(MainWindow::USE_PCT_CORE));
-        appendToOutput(QString("Main thread ID: %1").arg((quintptr)QThread::currentThreadId()));
-    }
-
-    void parallelSort() {
-        int vectorSize = data->size();
-        int numThreads = m_pool->maxThreadCount();
-        if (numThreads == 0) {
-            appendToOutput("Error: Thread pool has 0 max threads. Cannot sort.");
-            return;
-        }
-        int chunkSize = (vectorSize > 0 && numThreads > 0) ? std::max(1, vectorSize / numThreads) : 1;
-
-        appendToOutput("=== PHASE 1: Sorting chunks in parallel ===");
-        appendToOutput(QString("Vector size: %1").arg(vectorSize));
-        appendToOutput(QString("Chunk size: %1 (numThreads: %2)").arg(chunkSize).arg(numThreads));
-
-        for (int i = 0; i < numThreads; i++) {
-            int start = i * chunkSize;
-            int end = (i == numThreads - 1) ? vectorSize : (i + 1) * chunkSize;
-            if (start >= vectorSize) break;
-            end = std::min(end, vectorSize);
-            if (start >= end) continue;
-
-            SortTask* task = new SortTask(data, start, end, i);
-            m_pool->start(task);
-        }
-
-        while (!m_pool->waitForDone(100)) {
-            QApplication::processEvents();
-        }
-
-        appendToOutput("=== PHASE 2: Merging sorted chunks ===");
-        std::vector<std::pair<int, int>> chunks;
-        for (int i = 0; i < numThreads; i++) {
-            int start = i * chunkSize;
-            int end = (i == numThreads - 1) ? vectorSize : (i + 1) * chunkSize;
-            if (start >= vectorSize) break;
-            end = std::min(end, vectorSize);
-            if (start >= end) continue;
-            chunks.push_back({start, end});
-        }
-
-        int mergeTaskId = 0;
-        while (chunks.size() > 1) {
-            std::vector<std::pair<int, int>> newChunks;
-            for (size_t i = 0; i < chunks.size(); i += 2) {
-                if (i + 1 < chunks.size()) {
-                    int start1 = chunks[i].first;
-                    int end1 = chunks[i].second;
-                    int start2 = chunks[i + 1].first;
-                    int end2 = chunks[i + 1].second;
-                    MergeTask* mergeTask = new MergeTask(data, start1, end1, start2, end2, mergeTaskId++);
-                    m_pool->start(mergeTask);
-                    newChunks.push_back({start1, end2});
-                } else {
-                    newChunks.push_back(chunks[i]);
-                }
-            }
-            while (!m_pool->waitForDone(100)) {
-                QApplication::processEvents();
-            }
-            chunks = newChunks;
-        }
-        appendToOutput("=== Sorting complete! ===");
-    }
-};
-
-bool isSorted(const std::vector<int>& vec) {
-    for (size_t i = 1; i < vec.size(); i++) {
-        if (vec[i] < vec[i - 1]) {
-            return false;
-        }
-    }
-    return true;
-}
-
-void printSample(const std::vector<int>& vec, const QString& label) {
-    appendToOutput(label);
-    QString firstElements = "First 10 elements: ";
-    int firstCount = std::min(10, (int)vec.size());
-    for (int i = 0; i < firstCount; i++) {
-        firstElements += QString::number(vec[i]);
-        if (i < firstCount - 1) firstElements += ", ";
-    }
-    appendToOutput(firstElements);
-
-    if (vec.empty()) return;
-
-    QString lastElements = "Last 10 elements: ";
-    int lastCount = std::min(10, (int)vec.size());
-    for (size_t i = std::max(0, (int)vec.size() - lastCount); i < vec.size(); i++) {
-        lastElements += QString::number(vec[i]);
-        if (i < vec.size() - 1) lastElements += ", ";
-    }
-    appendToOutput(lastElements);
-}
-
-
-// === Task 2: String Matrix Population and Sorting ===
-
-QString generateRandomString(int length) {
-    const QString possibleCharacters("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789");
-    QString randomString;
-    randomString.reserve(length);
-    for (int i = 0; i < length; ++i) {
-        int index = QRandomGenerator::global()->bounded(possibleCharacters.length());
-        randomString.append(possibleCharacters.at(index));
-    }
-    return randomString;
-}
-
-class PopulateStringRowTask : public QRunnable {
-private:
-    std::vector<std::vector<QString>>* m_matrix;
-    int m_rowIndex;
-    int m_numCols;
-    int m_stringLength;
-
-public:
-    PopulateStringRowTask(std::vector<std::vector<QString>>* matrix, int rowIndex, int numCols, int stringLength)
-        : m_matrix(matrix), m_rowIndex(rowIndex), m_numCols(numCols), m_stringLength(stringLength) {
-        setAutoDelete(true);
-    }
-
-    void run() override {
-        std::vector<QString>& row = (*m_matrix)[m_rowIndex];
-        row.resize(m_numCols);
-        for (int j = 0; j < m_numCols; ++j) {
-            row[j] = generateRandomString(m_stringLength);
-        }
-    }
-};
-
-class SortStringRowTask : public QRunnable {
-private:
-    std::vector<std::vector<QString>>* m_matrix;
-    int m_rowIndex;
-
-public:
-    SortStringRowTask(std::vector<std::vector<QString>>* matrix, int rowIndex)
-        : m_matrix(matrix), m_rowIndex(rowIndex) {
-        setAutoDelete(true);
-    }
-
-    void run() override {
-        std::sort((*m_matrix)[m_rowIndex].begin(), (*m_matrix)[m_rowIndex].end());
-    }
-};
-
-class StringMatrixProcessor {
-private:
-    std::vector<std::vector<QString>>* m_matrix;
-    QThreadPool* m_pool;
-    int m_numRows;
-    int m_numCols;
-    int m_stringLength;
-
-public:
-    StringMatrixProcessor(std::vector<std::vector<QString>>* matrix, QThreadPool* pool, int rows, int cols, int strLen)
-        : m_matrix(matrix), m_pool(pool), m_numRows(rows), m_numCols(cols), m_stringLength(strLen) {}
-
-    void populate() {
-        appendToOutput(QString("Populating %1x%2 string matrix with %3-char strings...").arg(m_numRows).arg(m_numCols).arg(m_stringLength));
-        for (int i = 0; i < m_numRows; ++i) {
-            PopulateStringRowTask* task = new PopulateStringRowTask(m_matrix, i, m_numCols, m_stringLength);
-            m_pool->start(task);
-        }
-        while (!m_pool->waitForDone(100)) { QApplication::processEvents(); }
-        appendToOutput("String matrix population complete.");
-    }
-
-    void sortRows() {
-        appendToOutput(QString("Sorting %1 rows of string matrix...").arg(m_numRows));
-        for (int i = 0; i < m_numRows; ++i) {
-            SortStringRowTask* task = new SortStringRowTask(m_matrix, i);
-            m_pool->start(task);
-        }
-        while (!m_pool->waitForDone(100)) { QApplication::processEvents(); }
-        appendToOutput("String matrix row sorting complete.");
-    }
-};
-
-
-// === Task 3: Decrement Vector Elements ===
-
-class PopulateDecrementVectorTask : public QRunnable {
-private:
-    std::vector<int>* m_data;
-    int m_startIndex;
-    int m_endIndex;
-    int m_maxValue;
-public:
-    PopulateDecrementVectorTask(std::vector<int>* data, int start, int end, int maxValue)
-        : m_data(data), m_startIndex(start), m_endIndex(end), m_maxValue(maxValue) {
-        setAutoDelete(true);
-    }
-    void run() override {
-        std::random_device rd;
-        std::mt19937 gen(rd() ^ ( (std::mt19937::result_type)
-                                 std::chrono::duration_cast<std::chrono::seconds>(
-                                     std::chrono::system_clock::now().time_since_epoch()
-                                 ).count() +
-                                 (std::mt19937::result_type)
-                                 std::hash<std::thread::id>()(std::this_thread::get_id()) ) );
-        std::uniform_int_distribution<> dis(1, m_maxValue);
-        for (int i = m_startIndex; i < m_endIndex; ++i) {
-            (*m_data)[i] = dis(gen);
-        }
-    }
-};
-
-class DecrementChunkTask : public QRunnable {
-private:
-    std::vector<int>* m_data;
-    int m_startIndex;
-    int m_endIndex;
-    QAtomicInt* m_chunkNonZeroCount; // Changed to QAtomicInt*
-
-public:
-    DecrementChunkTask(std::vector<int>* data, int start, int end, QAtomicInt* chunkNonZeroCount) // Changed type
-        : m_data(data), m_startIndex(start), m_endIndex(end), m_chunkNonZeroCount(chunkNonZeroCount) {
-        setAutoDelete(true);
-    }
-
-    void run() override {
-        int currentNonZero = 0; // QAtomicInt operates on int
-        QRandomGenerator random = QRandomGenerator::securelySeeded();
-
-        for (int i = m_startIndex; i < m_endIndex; ++i) {
-            if ((*m_data)[i] > 0) {
-                if (random.bounded(2) == 0) { // 50% chance
-                    (*m_data)[i]--;
-                }
-                if ((*m_data)[i] > 0) {
-                    currentNonZero++;
-                }
-            }
-        }
-        m_chunkNonZeroCount->store(currentNonZero); // Use QAtomicInt API
-    }
-};
-
-class DecrementProcessor {
-private:
-    std::vector<int>* m_data;
-    QThreadPool* m_pool;
-    int m_vectorSize;
-    QVector<QAtomicInt> m_chunkNonZeroCounts; // Changed to QVector<QAtomicInt>
-
-public:
-    DecrementProcessor(std::vector<int>* data, QThreadPool* pool, int vectorSize)
-        : m_data(data), m_pool(pool), m_vectorSize(vectorSize) {}
-
-    void populateVector(int maxValue) {
-        appendToOutput(QString("Populating vector of size %1 with random values up to %2 for decrement task...").arg(m_vectorSize).arg(maxValue));
-        int numThreads = m_pool->maxThreadCount();
-        if (numThreads == 0) { appendToOutput("Error: Thread pool has 0 threads for population."); return; }
-        int chunkSize = (m_vectorSize > 0 && numThreads > 0) ? std::max(1, m_vectorSize / numThreads) : 1;
-
-        for (int i = 0; i < numThreads; ++i) {
-            int start = i * chunkSize;
-            int end = (i == numThreads - 1) ? m_vectorSize : (i + 1) * chunkSize;
-            if (start >= m_vectorSize) break;
-            end = std::min(end, m_vectorSize);
-            if (start >= end) continue;
-
-            PopulateDecrementVectorTask* task = new PopulateDecrementVectorTask(m_data, start, end, maxValue);
-            m_pool->start(task);
-        }
-        while (!m_pool->waitForDone(100)) { QApplication::processEvents(); }
-        appendToOutput("Decrement vector population complete.");
-    }
-
-    qint64 decrementToZero() {
-        appendToOutput("Starting decrement process...");
-        QElapsedTimer timer;
-        timer.start();
-
-        int numThreads = m_pool->maxThreadCount();
-        if (numThreads == 0) {
-            appendToOutput("Error: Thread pool has 0 threads for decrementing.");
-            return -1;
-        }
-
-        m_chunkNonZeroCounts.clear();
-        // This resize call should default-construct 'numThreads' QAtomicInt objects.
-        // Default construction for QAtomicInt initializes it to zero.
-        m_chunkNonZeroCounts.resize(numThreads);
-
-
-        int passCount = 0;
-        while (true) {
-            passCount++;
-            long long totalNonZeroElementsInPass = 0; // Sum can be larger than int
-            int chunkSize = (m_vectorSize > 0 && numThreads > 0) ? std::max(1, m_vectorSize / numThreads) : 1;
-
-            for (int i = 0; i < numThreads; ++i) {
-                int start = i * chunkSize;
-                int end = (i == numThreads - 1) ? m_vectorSize : (i + 1) * chunkSize;
-                if (start >= m_vectorSize) break;
-                end = std::min(end, m_vectorSize);
-                if (start >= end) continue;
-
-                if (i < m_chunkNonZeroCounts.size()) { // QVector uses int for size and index
-                    DecrementChunkTask* task = new DecrementChunkTask(m_data, start, end, &m_chunkNonZeroCounts[i]);
-                    m_pool->start(task);
-                } else {
-                     appendToOutput(QString("Error: Task index %1 out of bounds for m_chunkNonZeroCounts (size %2). Skipping task.")
-                               .arg(i).arg(m_chunkNonZeroCounts.size()));
-                }
-            }
-
-            while (!m_pool->waitForDone(100)) { QApplication::processEvents(); }
-
-            for (int i = 0; i < numThreads; ++i) {
-                 int start = i * chunkSize;
-                 if (start >= m_vectorSize) break;
-
-                if (i < m_chunkNonZeroCounts.size()) {
-                   totalNonZeroElementsInPass += m_chunkNonZeroCounts[i].load(); // Use QAtomicInt API
-                }
-            }
-
-            appendToOutput(QString("Decrement Pass %1: %2 elements remaining > 0.").arg(passCount).arg(totalNonZeroElementsInPass));
-
-            if (totalNonZeroElementsInPass == 0) {
-                break;
-            }
-            QApplication::processEvents();
-        }
-
-        qint64 elapsed = timer.elapsed();
-        appendToOutput(QString("Decrement process complete. All elements are zero. Took %1 passes.").arg(passCount));
-        return elapsed;
-    }
-};
+// Combo indices after the in-memory ParallelSorter<int>::SortMode entries
+static const int EXTERNAL_SORT_MODE = ParallelSorter<int>::SampleSort + 1;
+static const int PIPELINED_SORT_MODE = EXTERNAL_SORT_MODE + 1;
 
 
 // === MainWindow Implementation ===
-MainWindow::MainWindow(QWidget* parent) : QWidget(parent) {
+MainWindow::MainWindow(QWidget* parent)
+    : QWidget(parent), m_outputQueue(new LogRing(OUTPUT_QUEUE_CAPACITY)), m_jobsSubmitted(0),
+      m_seed(QRandomGenerator::global()->generate64()) {
     setWindowTitle("Parallel Tasks Demo");
     setFixedSize(800, 700);
-    g_mainWindow = this;
+    setOutputSink([this](const QString& text) { appendOutput(text); });
 
     m_sharedThreadPool = new QThreadPool(this);
     int totalCores = QThread::idealThreadCount();
     int usableCores = std::max(1, totalCores > 1 ? totalCores - 1 : 1);
     m_sharedThreadPool->setMaxThreadCount(usableCores);
+    m_sorter = new ParallelSorter<int>(m_sharedThreadPool);
+    m_sorter->setLogger(appendToOutput);
+    m_sorter->setCoreUtilization(USE_PCT_CORE);
+    m_scheduler = new JobScheduler(m_sharedThreadPool);
 
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
     statusLabel = new QLabel("Select a task to begin.");
     statusLabel->setWordWrap(true);
+    progressBar = new QProgressBar();
+    progressBar->setRange(0, 100);
+    progressBar->setValue(0);
 
     QHBoxLayout* buttonLayout = new QHBoxLayout();
+    sortModeCombo = new QComboBox();
+    sortModeCombo->addItem("K-way merge sort");  // ParallelSorter<int>::MergeSort
+    sortModeCombo->addItem("LSD radix sort");    // ParallelSorter<int>::RadixSort
+    sortModeCombo->addItem("Samplesort");        // ParallelSorter<int>::SampleSort
+    sortModeCombo->addItem("External merge sort (on disk)"); // EXTERNAL_SORT_MODE
+    sortModeCombo->addItem("Pipelined generate + sort + verify"); // PIPELINED_SORT_MODE
     startButton = new QPushButton("Start Number Sort (Task 1)");
     startStringMatrixButton = new QPushButton("Start String Matrix (Task 2)");
     startDecrementButton = new QPushButton("Start Decrement Task (Task 3)");
+    priorityCombo = new QComboBox();
+    priorityCombo->addItem("Low priority");    // AsyncJob::LowPriority
+    priorityCombo->addItem("Normal priority"); // AsyncJob::NormalPriority
+    priorityCombo->addItem("High priority");   // AsyncJob::HighPriority
+    priorityCombo->setCurrentIndex(AsyncJob::NormalPriority - AsyncJob::LowPriority);
+    cancelButton = new QPushButton("Cancel All");
+    cancelButton->setEnabled(false);
     clearButton = new QPushButton("Clear Output");
 
+    buttonLayout->addWidget(sortModeCombo);
     buttonLayout->addWidget(startButton);
     buttonLayout->addWidget(startStringMatrixButton);
     buttonLayout->addWidget(startDecrementButton);
+    buttonLayout->addWidget(priorityCombo);
     buttonLayout->addStretch();
+    buttonLayout->addWidget(cancelButton);
     buttonLayout->addWidget(clearButton);
 
     outputText = new QTextEdit();
     outputText->setReadOnly(true);
     outputText->setFont(QFont("Courier", 9));
+    outputText->document()->setMaximumBlockCount(OUTPUT_MAX_LINES);
+
+    m_outputTimer = new QTimer(this);
+    m_outputTimer->setInterval(OUTPUT_DRAIN_INTERVAL_MS);
+    connect(m_outputTimer, &QTimer::timeout, this, &MainWindow::drainOutput);
+    m_outputTimer->start();
 
     mainLayout->addWidget(statusLabel);
+    mainLayout->addWidget(progressBar);
     mainLayout->addLayout(buttonLayout);
     mainLayout->addWidget(outputText, 1);
 
     connect(startButton, &QPushButton::clicked, this, &MainWindow::runSortingDemo);
     connect(startStringMatrixButton, &QPushButton::clicked, this, &MainWindow::runStringMatrixTask);
     connect(startDecrementButton, &QPushButton::clicked, this, &MainWindow::runDecrementTask);
+    connect(cancelButton, &QPushButton::clicked, this, &MainWindow::cancelAllTasks);
     connect(clearButton, &QPushButton::clicked, this, &MainWindow::clearOutput);
 
     appendToOutput(QString("GUI Application started. Shared thread pool configured with %1 max threads.").arg(usableCores));
     appendToOutput(QString("System has %1 ideal cores.").arg(totalCores));
+    appendToOutput(QString("Integer sort kernels: %1").arg(simdLevelName(simdLevel())));
 }
 
 MainWindow::~MainWindow() {
-    g_mainWindow = nullptr;
+    delete m_scheduler; // Cancels every job and waits for the running ones; their bodies use data and m_sorter
+    qDeleteAll(m_jobs); // Joins the driver threads
+    delete m_sorter;
+    setOutputSink(OutputSink());
+    delete m_outputQueue;
 }
 
 void MainWindow::appendOutput(const QString& text) {
-    QMetaObject::invokeMethod(this, [this, text]() {
-        outputText->append(text);
-        outputText->ensureCursorVisible();
-    }, Qt::QueuedConnection);
+    m_outputQueue->push(text);
+}
+
+// One append (and one relayout) per tick instead of one per line.
+void MainWindow::drainOutput() {
+    QStringList lines;
+    m_outputQueue->drain(&lines, OUTPUT_DRAIN_BATCH);
+    quint64 dropped = m_outputQueue->takeDropped();
+    if (dropped > 0) {
+        lines.append(QString("[%1 output lines dropped: output queue full]").arg(dropped));
+    }
+    if (lines.isEmpty()) return;
+    outputText->append(lines.join('\n'));
+    outputText->ensureCursorVisible();
+}
+
+void MainWindow::setRandomSeed(quint64 seed) {
+    m_seed = seed;
+}
+
+void MainWindow::setTraceFile(const QString& path) {
+    m_traceFile = path;
+}
+
+void MainWindow::setNumaPlacement(bool pinWorkers, bool firstTouch) {
+    NumaPlacement::setPinWorkers(pinWorkers);
+    NumaPlacement::setFirstTouch(firstTouch);
+    if (pinWorkers) {
+        m_sharedThreadPool->setExpiryTimeout(-1); // Keep pinned workers instead of replacing them
+    }
+    if (pinWorkers || firstTouch) {
+        appendOutput(QString("NUMA placement: %1; worker pinning %2, first-touch placement %3")
+                     .arg(NumaPlacement::describe())
+                     .arg(pinWorkers ? "on" : "off")
+                     .arg(firstTouch ? "on" : "off"));
+    }
 }
 
 void MainWindow::clearOutput() {
@@ -547,68 +173,158 @@ void MainWindow::clearOutput() {
     appendOutput("Output cleared. Ready for next demo!");
 }
 
+void MainWindow::startJob(const QString& title, const QString& resource, qint64 workItems, const QString& workUnit,
+                          const std::function<void(AsyncJob*)>& body) {
+    AsyncJob* job = new AsyncJob(QString("%1 #%2").arg(title).arg(++m_jobsSubmitted), body);
+    job->setPriority(static_cast<AsyncJob::Priority>(priorityCombo->currentIndex() + AsyncJob::LowPriority));
+    job->setWorkSize(workItems, workUnit);
+    appendOutput(QString("%1: random seed %2 (run with --seed %2 to reproduce)").arg(job->name()).arg(m_seed));
+    submitJob(job, resource);
+}
+
+void MainWindow::submitJob(AsyncJob* job, const QString& resource) {
+    if (m_jobs.isEmpty()) {
+        progressBar->setValue(0);
+        if (!m_traceFile.isEmpty()) {
+            TaskTrace::clear(); // The pool is idle between bursts of jobs
+            TaskTrace::setEnabled(true);
+        }
+    }
+    m_jobs.append(job);
+    connect(job, &AsyncJob::progressChanged, this, [this, job](int percent, const QString& phase) {
+        onJobProgress(job, percent, phase);
+    });
+    connect(job, &AsyncJob::finished, this, [this, job](bool cancelled) { onJobFinished(job, cancelled); });
+    m_scheduler->submit(job, resource);
+    cancelButton->setEnabled(true);
+    appendOutput(QString("Queued %1 at %2 priority (%3 running, %4 queued)")
+                 .arg(job->name()).arg(AsyncJob::priorityName(job->priority()))
+                 .arg(m_scheduler->runningJobs()).arg(m_scheduler->queuedJobs()));
+    statusLabel->setText(QString("%1 submitted... Watch output.").arg(job->name()));
+}
+
+void MainWindow::cancelAllTasks() {
+    if (m_jobs.isEmpty()) return;
+    m_scheduler->cancelAll();
+    cancelButton->setEnabled(false);
+    statusLabel->setText(QString("Cancelling %1 job(s)...").arg(m_jobs.size()));
+}
+
+void MainWindow::onJobProgress(AsyncJob* job, int percent, const QString& phase) {
+    progressBar->setValue(percent);
+    QString text = QString("%1 in progress: %2 (%3%)").arg(job->name()).arg(phase).arg(percent);
+    if (m_jobs.size() > 1) text += QString(" - %1 jobs active").arg(m_jobs.size());
+    statusLabel->setText(text);
+}
+
+void MainWindow::onJobFinished(AsyncJob* job, bool cancelled) {
+    QString title = job->name();
+    m_jobs.removeOne(job);
+    QString status;
+    if (cancelled) {
+        appendOutput(QString("=").repeated(60));
+        appendOutput(QString("%1 CANCELLED").arg(title.toUpper()));
+        appendOutput(QString("=").repeated(60) + "\n");
+        status = QString("%1 cancelled.").arg(title);
+    } else {
+        appendOutput(QString("%1 (%2 priority): queued %3 ms, ran %4 ms, %5 M %6/s")
+                     .arg(title).arg(AsyncJob::priorityName(job->priority()))
+                     .arg(job->queueTimeMs()).arg(job->runTimeMs())
+                     .arg(job->throughput() / 1e6, 0, 'f', 2).arg(job->workUnit()));
+        status = QString("%1 complete!").arg(title);
+    }
+    job->deleteLater();
+
+    if (!m_jobs.isEmpty()) {
+        statusLabel->setText(QString("%1 %2 job(s) still active.").arg(status).arg(m_jobs.size()));
+        return;
+    }
+    progressBar->setValue(cancelled ? 0 : 100);
+    cancelButton->setEnabled(false);
+    statusLabel->setText(status + " Select a task to begin.");
+    if (!m_traceFile.isEmpty()) {
+        TaskTrace::setEnabled(false);
+        if (TaskTrace::writeChromeJson(m_traceFile)) {
+            appendOutput(QString("Task trace: %1 tasks (%2 dropped) written to %3")
+                         .arg(TaskTrace::eventCount()).arg(TaskTrace::droppedCount()).arg(m_traceFile));
+        } else {
+            appendOutput(QString("Could not write task trace to %1").arg(m_traceFile));
+        }
+    }
+}
+
+// Each task's buffers are its scheduler resource, so a second run of the
+// same task waits for the first while other tasks run beside it.
 void MainWindow::runSortingDemo() {
-    startButton->setEnabled(false);
-    startStringMatrixButton->setEnabled(false);
-    startDecrementButton->setEnabled(false);
-    statusLabel->setText("Task 1 (Number Sort) in progress... Watch output.");
+    int mode = sortModeCombo->currentIndex();
+    qint64 elements = mode == EXTERNAL_SORT_MODE ? EXTERNAL_SORT_ELEMENTS : VECTOR_SIZE;
+    startJob("Task 1 (Number Sort)", "data", elements, "elements",
+             [this, mode](AsyncJob* job) { sortingDemo(job, mode); });
+}
+
+void MainWindow::generateSortData(AsyncJob* job, quint64 firstIndex) {
+    generateRandomInts(&data, m_sharedThreadPool, m_seed, firstIndex, VECTOR_SIZE, job);
+}
+
+// Runs on the job's driver thread; only appendOutput() and job signals reach the GUI.
+void MainWindow::sortingDemo(AsyncJob* job, int mode) {
+    if (mode == EXTERNAL_SORT_MODE) {
+        externalSortDemo(job);
+        return;
+    }
+    if (mode == PIPELINED_SORT_MODE) {
+        pipelinedSortDemo(job);
+        return;
+    }
+
     appendOutput("\n" + QString("=").repeated(60));
     appendOutput("STARTING TASK 1: PARALLEL NUMBER SORTING DEMO");
     appendOutput(QString("=").repeated(60));
 
-    data.resize(VECTOR_SIZE);
+    resizeForOverwrite(&data, VECTOR_SIZE, m_sharedThreadPool, job);
     appendToOutput(QString("Generating %1 random integers using shared pool...").arg(VECTOR_SIZE));
 
-    int numGenThreads = m_sharedThreadPool->maxThreadCount();
-    if (numGenThreads == 0) {
+    if (m_sharedThreadPool->maxThreadCount() == 0) {
         appendToOutput("Error: Cannot generate numbers, pool has 0 threads.");
-        startButton->setEnabled(true);
-        startStringMatrixButton->setEnabled(true);
-        startDecrementButton->setEnabled(true);
-        statusLabel->setText("Error: Thread pool unavailable. Select a task.");
         return;
     }
-    int genChunkSize = (VECTOR_SIZE > 0 && numGenThreads > 0) ? std::max(1, VECTOR_SIZE / numGenThreads) : 1;
-
-    for (int i = 0; i < numGenThreads; i++) {
-        int start = i * genChunkSize;
-        int end = (i == numGenThreads - 1) ? VECTOR_SIZE : (i + 1) * genChunkSize;
-        if (start >= VECTOR_SIZE) break;
-        end = std::min(end, (int)VECTOR_SIZE);
-        if (start >= end) continue;
-        RandomGenTask* genTask = new RandomGenTask(&data, start, end);
-        m_sharedThreadPool->start(genTask);
-    }
-    while (!m_sharedThreadPool->waitForDone(100)) { QApplication::processEvents(); }
+    generateSortData(job);
+    if (job->isCancelled()) return;
 
     printSample(data, "\nOriginal vector (unsorted):");
 
     QElapsedTimer timer;
     timer.start();
+    job->beginPhase("Digesting input");
+    MultisetDigest inputDigest = parallelMultisetDigest(data.data(), (qint64)data.size(), m_sharedThreadPool, job);
+    qint64 verifyTime = timer.elapsed();
+    if (job->isCancelled()) return;
 
-    ParallelSorter sorter(&data, m_sharedThreadPool);
-    sorter.parallelSort();
-
+    timer.restart();
+    m_sorter->parallelSort(&data, static_cast<ParallelSorter<int>::SortMode>(mode), job);
+    if (job->isCancelled()) return;
     qint64 parallelTime = timer.elapsed();
-    bool sorted = isSorted(data);
+
+    timer.restart();
+    job->beginPhase("Verifying sorted output");
+    bool sorted = parallelIsSorted(data.data(), (qint64)data.size(), m_sharedThreadPool, std::less<int>(), job);
+    MultisetDigest outputDigest = parallelMultisetDigest(data.data(), (qint64)data.size(), m_sharedThreadPool, job);
+    verifyTime += timer.elapsed();
+    if (job->isCancelled()) return;
+
     appendOutput(QString("\nVector is sorted: %1").arg(sorted ? "true" : "false"));
+    appendOutput(QString("Vector is a permutation of the input: %1").arg(outputDigest == inputDigest ? "true" : "false"));
     printSample(data, "\nSorted vector:");
     appendOutput(QString("\nParallel sort took: %1 ms").arg(parallelTime));
+    appendOutput(QString("Parallel verification took: %1 ms").arg(verifyTime));
 
     appendOutput("\nNow testing single-threaded sort for comparison...");
-    appendOutput("Regenerating random data using shared pool...");
-
-    for (int i = 0; i < numGenThreads; i++) {
-        int start = i * genChunkSize;
-        int end = (i == numGenThreads - 1) ? VECTOR_SIZE : (i + 1) * genChunkSize;
-        if (start >= VECTOR_SIZE) break;
-        end = std::min(end, (int)VECTOR_SIZE);
-        if (start >= end) continue;
-        RandomGenTask* genTask = new RandomGenTask(&data, start, end);
-        m_sharedThreadPool->start(genTask);
-    }
-    while (!m_sharedThreadPool->waitForDone(100)) { QApplication::processEvents(); }
+    appendOutput("Regenerating the same random data (same seed) using shared pool...");
+
+    generateSortData(job);
+    if (job->isCancelled()) return;
 
+    job->beginPhase("Single-threaded std::sort baseline");
     timer.restart();
     std::sort(data.begin(), data.end());
     qint64 singleThreadTime = timer.elapsed();
@@ -624,28 +340,159 @@ void MainWindow::runSortingDemo() {
     appendOutput(QString("=").repeated(60));
     appendOutput("TASK 1 (NUMBER SORT) COMPLETE");
     appendOutput(QString("=").repeated(60) + "\n");
+}
+
+// Generates, sorts and verifies 'data' in one fused pass, then repeats the
+// same work as separate full sweeps for comparison.
+void MainWindow::pipelinedSortDemo(AsyncJob* job) {
+    appendOutput("\n" + QString("=").repeated(60));
+    appendOutput("STARTING TASK 1: PIPELINED GENERATE, SORT AND VERIFY DEMO");
+    appendOutput(QString("=").repeated(60));
+
+    if (m_sharedThreadPool->maxThreadCount() == 0) {
+        appendToOutput("Error: Cannot generate numbers, pool has 0 threads.");
+        return;
+    }
+    resizeForOverwrite(&data, VECTOR_SIZE, m_sharedThreadPool, job);
+    appendToOutput(QString("Generating, sorting and verifying %1 random integers chunk by chunk...").arg(VECTOR_SIZE));
+
+    QElapsedTimer timer;
+    timer.start();
+    SliceSortCheck<int> check;
+    ingestRandomInts(m_sorter, &data, m_seed, 0, VECTOR_SIZE, &check, job);
+    if (job->isCancelled()) return;
+    qint64 pipelinedTime = timer.elapsed();
+
+    appendOutput(QString("\nVector is sorted: %1").arg(check.isSorted((qint64)data.size()) ? "true" : "false"));
+    appendOutput(QString("Vector is a permutation of the input: %1").arg(check.isPermutation() ? "true" : "false"));
+    printSample(data, "\nSorted vector:");
+    appendOutput(QString("\nPipelined generate + sort + verify took: %1 ms").arg(pipelinedTime));
+
+    appendOutput("\nNow running the same steps as separate passes for comparison...");
+    timer.restart();
+    generateSortData(job);
+    if (job->isCancelled()) return;
+    job->beginPhase("Digesting input");
+    MultisetDigest inputDigest = parallelMultisetDigest(data.data(), (qint64)data.size(), m_sharedThreadPool, job);
+    if (job->isCancelled()) return;
+    m_sorter->parallelSort(&data, ParallelSorter<int>::MergeSort, job);
+    if (job->isCancelled()) return;
+    job->beginPhase("Verifying sorted output");
+    bool sorted = parallelIsSorted(data.data(), (qint64)data.size(), m_sharedThreadPool, std::less<int>(), job);
+    bool permutation = parallelMultisetDigest(data.data(), (qint64)data.size(), m_sharedThreadPool, job) == inputDigest;
+    if (job->isCancelled()) return;
+    qint64 stagedTime = timer.elapsed();
+    appendOutput(QString("Separate passes took: %1 ms (sorted: %2, permutation: %3)")
+                 .arg(stagedTime).arg(sorted ? "true" : "false").arg(permutation ? "true" : "false"));
+
+    if (pipelinedTime > 0) {
+        appendOutput(QString("Pipelining speedup: %1x").arg((double)stagedTime / pipelinedTime, 0, 'f', 2));
+    }
+
+    appendOutput(QString("=").repeated(60));
+    appendOutput("TASK 1 (PIPELINED SORT) COMPLETE");
+    appendOutput(QString("=").repeated(60) + "\n");
+}
+
+// Writes EXTERNAL_SORT_ELEMENTS random integers to a temporary file, generated
+// VECTOR_SIZE at a time in 'data', and sorts the file with a RAM budget well
+// below its size.
+void MainWindow::externalSortDemo(AsyncJob* job) {
+    appendOutput("\n" + QString("=").repeated(60));
+    appendOutput("STARTING TASK 1: EXTERNAL (OUT-OF-CORE) SORT DEMO");
+    appendOutput(QString("=").repeated(60));
+
+    if (m_sharedThreadPool->maxThreadCount() == 0) {
+        appendToOutput("Error: Cannot generate numbers, pool has 0 threads.");
+        return;
+    }
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        appendOutput("Error: Cannot create a temporary directory for the input and output files.");
+        return;
+    }
+    QString inputPath = workDir.filePath("input.bin");
+    QString outputPath = workDir.filePath("sorted.bin");
+
+    appendToOutput(QString("Writing %1 random integers (%2 MB) to %3...")
+                   .arg(EXTERNAL_SORT_ELEMENTS)
+                   .arg((qint64)EXTERNAL_SORT_ELEMENTS * (qint64)sizeof(int) / (1024 * 1024))
+                   .arg(inputPath));
+    QFile input(inputPath);
+    if (!input.open(QIODevice::WriteOnly)) {
+        appendOutput(QString("Error: Cannot create %1: %2").arg(inputPath, input.errorString()));
+        return;
+    }
+    resizeForOverwrite(&data, VECTOR_SIZE, m_sharedThreadPool, job);
+    MultisetDigest inputDigest; // Digests of the blocks add up to the digest of the file
+    for (int written = 0; written < EXTERNAL_SORT_ELEMENTS; written += VECTOR_SIZE) {
+        generateSortData(job, (quint64)written);
+        if (job->isCancelled()) return;
+        qint64 count = std::min(VECTOR_SIZE, EXTERNAL_SORT_ELEMENTS - written);
+        inputDigest += parallelMultisetDigest(data.data(), count, m_sharedThreadPool, job);
+        qint64 bytes = count * (qint64)sizeof(int);
+        if (input.write((const char*)data.data(), bytes) != bytes) {
+            appendOutput(QString("Error: Writing %1 failed: %2").arg(inputPath, input.errorString()));
+            return;
+        }
+    }
+    input.close();
 
-    statusLabel->setText("Task 1 complete! Select a task to begin.");
-    startButton->setEnabled(true);
-    startStringMatrixButton->setEnabled(true);
-    startDecrementButton->setEnabled(true);
+    QElapsedTimer timer;
+    timer.start();
+
+    ExternalSorter<int> sorter(m_sharedThreadPool, (qint64)EXTERNAL_SORT_MEMORY_MB * 1024 * 1024);
+    sorter.setLogger(appendToOutput);
+    sorter.setTempPath(workDir.path());
+    bool ok = sorter.sortFile(inputPath, outputPath, job);
+    if (job->isCancelled()) return;
+    if (!ok) {
+        appendOutput("Error: " + sorter.errorString());
+        return;
+    }
+    qint64 externalTime = timer.elapsed();
+
+    job->beginPhase("Verifying output file");
+    QFile output(outputPath);
+    const int* sorted = nullptr;
+    qint64 count = 0;
+    if (output.open(QIODevice::ReadOnly)) {
+        sorted = reinterpret_cast<const int*>(output.map(0, output.size()));
+        count = output.size() / (qint64)sizeof(int);
+    }
+    bool verified = sorted && count == EXTERNAL_SORT_ELEMENTS
+                    && parallelIsSorted(sorted, count, m_sharedThreadPool, std::less<int>(), job);
+    bool permutation = sorted && parallelMultisetDigest(sorted, count, m_sharedThreadPool, job) == inputDigest;
+    if (job->isCancelled()) return;
+    appendOutput(QString("\nOutput file holds %1 records, sorted: %2").arg(count).arg(verified ? "true" : "false"));
+    appendOutput(QString("Output file is a permutation of the input: %1").arg(permutation ? "true" : "false"));
+    if (sorted && count > 0) {
+        appendOutput(QString("First element: %1, last element: %2").arg(sorted[0]).arg(sorted[count - 1]));
+    }
+    appendOutput(QString("External sort took: %1 ms with a %2 MB memory budget")
+                 .arg(externalTime).arg(EXTERNAL_SORT_MEMORY_MB));
+
+    appendOutput(QString("=").repeated(60));
+    appendOutput("TASK 1 (EXTERNAL SORT) COMPLETE");
+    appendOutput(QString("=").repeated(60) + "\n");
 }
 
 void MainWindow::printStringMatrixSample(const QString& label) {
     appendToOutput(label);
-    if (stringData.empty()) {
+    if (stringData.isEmpty()) {
         appendToOutput("String matrix is empty.");
         return;
     }
 
-    for (int i = 0; i < std::min((int)stringData.size(), 3); ++i) {
+    for (int i = 0; i < std::min(stringData.rows(), 3); ++i) {
         QString rowStr = QString("Row %1 (first 5 elements): ").arg(i);
-        if (stringData[i].empty()) {
+        if (stringData.cols() == 0) {
             rowStr += "[empty]";
         } else {
-            for (int j = 0; j < std::min((int)stringData[i].size(), 5); ++j) {
-                rowStr += stringData[i][j];
-                if (j < std::min((int)stringData[i].size(), 5) - 1) rowStr += ", ";
+            for (int j = 0; j < std::min(stringData.cols(), 5); ++j) {
+                rowStr += stringData.at(i, j);
+                if (j < std::min(stringData.cols(), 5) - 1) rowStr += ", ";
             }
         }
         appendToOutput(rowStr);
@@ -653,28 +500,29 @@ void MainWindow::printStringMatrixSample(const QString& label) {
 }
 
 void MainWindow::runStringMatrixTask() {
-    startButton->setEnabled(false);
-    startStringMatrixButton->setEnabled(false);
-    startDecrementButton->setEnabled(false);
-    statusLabel->setText("Task 2 (String Matrix) in progress... Watch output.");
+    startJob("Task 2 (String Matrix)", "stringData", (qint64)STRING_MATRIX_ROWS * STRING_MATRIX_COLS, "strings",
+             [this](AsyncJob* job) { stringMatrixTask(job); });
+}
+
+void MainWindow::stringMatrixTask(AsyncJob* job) {
     appendOutput("\n" + QString("=").repeated(60));
     appendOutput("STARTING TASK 2: STRING MATRIX POPULATION AND SORT");
     appendOutput(QString("=").repeated(60));
 
-    stringData.assign(STRING_MATRIX_ROWS, std::vector<QString>());
-
-    StringMatrixProcessor processor(&stringData, m_sharedThreadPool, STRING_MATRIX_ROWS, STRING_MATRIX_COLS, STRING_LENGTH);
+    PackedStringMatrixProcessor processor(&stringData, m_sharedThreadPool, STRING_MATRIX_ROWS, STRING_MATRIX_COLS, STRING_LENGTH, job);
 
     QElapsedTimer timer;
     timer.start();
 
-    processor.populate();
+    processor.populate(m_seed);
+    if (job->isCancelled()) return;
     qint64 populateTime = timer.elapsed();
     appendToOutput(QString("String matrix population took: %1 ms").arg(populateTime));
     printStringMatrixSample("\nSample of populated string matrix (before sort):");
 
     timer.restart();
     processor.sortRows();
+    if (job->isCancelled()) return;
     qint64 sortTime = timer.elapsed();
     appendToOutput(QString("String matrix row sorting took: %1 ms").arg(sortTime));
     printStringMatrixSample("\nSample of sorted string matrix:");
@@ -685,44 +533,39 @@ void MainWindow::runStringMatrixTask() {
     appendOutput(QString("=").repeated(60));
     appendOutput("TASK 2 (STRING MATRIX) COMPLETE");
     appendOutput(QString("=").repeated(60) + "\n");
-
-    statusLabel->setText("Task 2 complete! Select a task to begin.");
-    startButton->setEnabled(true);
-    startStringMatrixButton->setEnabled(true);
-    startDecrementButton->setEnabled(true);
 }
 
-bool MainWindow::verifyAllZero(const std::vector<int>& vec) {
-    for (int val : vec) {
-        if (val != 0) return false;
-    }
-    return true;
+bool MainWindow::verifyAllZero(const BoundedIntVector& vec, AsyncJob* job) {
+    return vec.isAllZero(m_sharedThreadPool, job);
 }
 
 void MainWindow::runDecrementTask() {
-    startButton->setEnabled(false);
-    startStringMatrixButton->setEnabled(false);
-    startDecrementButton->setEnabled(false);
-    statusLabel->setText("Task 3 (Decrement Vector) in progress... Watch output.");
+    startJob("Task 3 (Decrement Vector)", "decrementData", DECREMENT_VECTOR_SIZE, "elements",
+             [this](AsyncJob* job) { decrementTask(job); });
+}
+
+void MainWindow::decrementTask(AsyncJob* job) {
     appendOutput("\n" + QString("=").repeated(60));
     appendOutput("STARTING TASK 3: DECREMENT VECTOR ELEMENTS TO ZERO");
     appendOutput(QString("=").repeated(60));
 
-    data.assign(DECREMENT_VECTOR_SIZE, 0);
-
-    DecrementProcessor processor(&data, m_sharedThreadPool, DECREMENT_VECTOR_SIZE);
+    DecrementProcessor processor(&decrementData, m_sharedThreadPool, DECREMENT_VECTOR_SIZE, job);
 
-    processor.populateVector(MAX_RANDOM_VALUE_DECREMENT);
-    printSample(data, "\nInitial vector for decrement task (first/last 10 elements):");
+    processor.populateVector(MAX_RANDOM_VALUE_DECREMENT, m_seed);
+    if (job->isCancelled()) return;
+    printSample(decrementData, "\nInitial vector for decrement task (first/last 10 elements):");
 
     qint64 decrementTime = processor.decrementToZero();
+    if (job->isCancelled()) return;
 
     if (decrementTime >= 0) {
         appendToOutput(QString("\nTotal time for decrement phase: %1 ms").arg(decrementTime));
-        bool allZero = verifyAllZero(data);
+        job->beginPhase("Verifying all elements are zero");
+        bool allZero = verifyAllZero(decrementData, job);
+        if (job->isCancelled()) return;
         appendToOutput(QString("Verification: All elements are zero = %1").arg(allZero ? "true" : "false"));
         if (!allZero) {
-             printSample(data, "\nSample of vector after decrement (if not all zero):");
+             printSample(decrementData, "\nSample of vector after decrement (if not all zero):");
         }
     } else {
         appendToOutput("\nDecrement task failed or was interrupted.");
@@ -731,9 +574,4 @@ void MainWindow::runDecrementTask() {
     appendOutput(QString("=").repeated(60));
     appendOutput("TASK 3 (DECREMENT VECTOR) COMPLETE");
     appendOutput(QString("=").repeated(60) + "\n");
-
-    statusLabel->setText("Task 3 complete! Select a task to begin.");
-    startButton->setEnabled(true);
-    startStringMatrixButton->setEnabled(true);
-    startDecrementButton->setEnabled(true);
 }
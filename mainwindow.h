@@ -2,14 +2,24 @@
 #define MAINWINDOW_H
 
 #include <QWidget>
+#include "workloads.h"
+#include "stringmatrix.h"
 #include <vector>
-#include <QMutex> // For outputMutex member
+#include <functional>
+#include <QList>
 
 // Forward declarations
 class QLabel;
 class QPushButton;
+class QComboBox;
+class QProgressBar;
 class QTextEdit;
 class QThreadPool;
+class QTimer;
+class LogRing;
+class JobScheduler;
+template <typename T, typename Compare> class ParallelSorter;
+class AsyncJob;
 
 class MainWindow : public QWidget
 {
@@ -19,45 +29,101 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
-    // Thread-safe method to append text to the output
+    // Thread-safe method to append text to the output. Lines are queued and
+    // shown in batches every OUTPUT_DRAIN_INTERVAL_MS.
     void appendOutput(const QString& text);
 
+    // Seed for all generated data; the same seed reproduces the same inputs
+    // regardless of thread count. Random unless set (see --seed).
+    void setRandomSeed(quint64 seed);
+
+    // When set, each job records a task timeline (see tasktrace.h) that is
+    // written to this path, replacing the previous job's, once it finishes.
+    void setTraceFile(const QString& path);
+
+    // Worker CPU pinning and first-touch page placement (see numaplacement.h).
+    void setNumaPlacement(bool pinWorkers, bool firstTouch);
+
+    // Runs 'job' on the shared pool beside the built-in tasks, under the
+    // same scheduler (see jobscheduler.h), and reports its queue time and
+    // throughput when it finishes. Takes ownership. Jobs naming the same
+    // resource never run at the same time.
+    void submitJob(AsyncJob* job, const QString& resource = QString());
+
     // Public constants that other classes can access
-    static const int VECTOR_SIZE = 10000000; // Original 100000000, reduced for quicker demo
+    static const int VECTOR_SIZE = DEFAULT_VECTOR_SIZE;
     static const int USE_PCT_CORE = 80;      // Use 80% of each core's capacity
 
+    // Output view: queued lines are drained on a timer, a bounded batch per
+    // tick, and only the newest OUTPUT_MAX_LINES are kept
+    static const int OUTPUT_QUEUE_CAPACITY = 16384;  // Lines beyond this are dropped, not waited for
+    static const int OUTPUT_DRAIN_INTERVAL_MS = 50;
+    static const int OUTPUT_DRAIN_BATCH = 2000;
+    static const int OUTPUT_MAX_LINES = 5000;
+
+    // Constants for Task 1's external (out-of-core) mode
+    static const int EXTERNAL_SORT_ELEMENTS = 100000000; // Sorted on disk, 10x VECTOR_SIZE
+    static const int EXTERNAL_SORT_MEMORY_MB = 64;       // RAM budget for run formation
+
     // Constants for Task 2 (String Matrix)
-    static const int STRING_MATRIX_ROWS = 5000;
-    static const int STRING_MATRIX_COLS = 500;
-    static const int STRING_LENGTH = 4;
+    static const int STRING_MATRIX_ROWS = DEFAULT_STRING_MATRIX_ROWS;
+    static const int STRING_MATRIX_COLS = DEFAULT_STRING_MATRIX_COLS;
+    static const int STRING_LENGTH = DEFAULT_STRING_LENGTH;
 
     // Constants for Task 3 (Decrement Vector)
-    static const int DECREMENT_VECTOR_SIZE = 5000000;
-    static const int MAX_RANDOM_VALUE_DECREMENT = 50;
+    static const int DECREMENT_VECTOR_SIZE = DEFAULT_DECREMENT_VECTOR_SIZE;
+    static const int MAX_RANDOM_VALUE_DECREMENT = DEFAULT_MAX_RANDOM_VALUE_DECREMENT;
 
 private slots:
     void runSortingDemo();
     void runStringMatrixTask();
     void runDecrementTask();
+    void cancelAllTasks();
     void clearOutput();
+    void drainOutput();
 
 private:
     QLabel* statusLabel;
+    QComboBox* sortModeCombo; // Task 1 engine, indexed by ParallelSorter<int>::SortMode, then EXTERNAL_SORT_MODE and PIPELINED_SORT_MODE
     QPushButton* startButton;
     QPushButton* startStringMatrixButton;
     QPushButton* startDecrementButton;
+    QComboBox* priorityCombo; // Priority of the next task, indexed by AsyncJob::Priority - LowPriority
+    QPushButton* cancelButton;
     QPushButton* clearButton;
+    QProgressBar* progressBar;
     QTextEdit* outputText;
+    LogRing* m_outputQueue;   // Filled from any thread, drained by m_outputTimer
+    QTimer* m_outputTimer;
 
-    std::vector<int> data; // Used by Task 1 (Original Sort) and Task 3 (Decrement)
-    std::vector<std::vector<QString>> stringData; // Used by Task 2
+    OverwriteVector<int> data; // Used by Task 1 (Original Sort)
+    BoundedIntVector decrementData; // Used by Task 3 (Decrement), narrowed to its value range
+    PackedStringMatrix stringData; // Used by Task 2
 
     QThreadPool* m_sharedThreadPool;
-    QMutex outputMutex; // Although appendOutput uses QMetaObject, having a general purpose one if needed
+    ParallelSorter<int, std::less<int>>* m_sorter; // Kept across runs so its scratch buffer is reused
+    JobScheduler* m_scheduler; // Admits jobs onto m_sharedThreadPool
+    QList<AsyncJob*> m_jobs;   // Submitted jobs whose finished() has not been handled yet
+    int m_jobsSubmitted;
+    quint64 m_seed;           // Counter-based RNG seed for generated data
+    QString m_traceFile;      // Chrome trace output, or empty
 
     // Helper private methods
+    void startJob(const QString& title, const QString& resource, qint64 workItems, const QString& workUnit,
+                  const std::function<void(AsyncJob*)>& body);
+    void onJobProgress(AsyncJob* job, int percent, const QString& phase);
+    void onJobFinished(AsyncJob* job, bool cancelled);
+
+    // Task bodies, run on the job's driver thread rather than the GUI thread
+    void sortingDemo(AsyncJob* job, int mode);
+    void generateSortData(AsyncJob* job, quint64 firstIndex = 0);
+    void externalSortDemo(AsyncJob* job);
+    void pipelinedSortDemo(AsyncJob* job);
+    void stringMatrixTask(AsyncJob* job);
+    void decrementTask(AsyncJob* job);
+
     void printStringMatrixSample(const QString& label);
-    bool verifyAllZero(const std::vector<int>& vec);
+    bool verifyAllZero(const BoundedIntVector& vec, AsyncJob* job);
 };
 
 #endif // MAINWINDOW_H
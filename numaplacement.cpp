@@ -0,0 +1,128 @@
+#include "numaplacement.h"
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+#include <algorithm>
+#include <vector>
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+std::atomic<bool> NumaPlacement::s_pinWorkers(false);
+std::atomic<bool> NumaPlacement::s_firstTouch(false);
+
+namespace {
+
+struct CpuTopology {
+    std::vector<int> pinOrder; // Allowed CPUs, alternating between nodes
+    int nodeCount;
+};
+
+#if defined(Q_OS_LINUX)
+// Parses a sysfs CPU list such as "0-15,32-47".
+std::vector<int> parseCpuList(const QString& text) {
+    std::vector<int> cpus;
+    for (const QString& part : text.trimmed().split(',')) {
+        if (part.isEmpty()) continue;
+        QStringList bounds = part.split('-');
+        int first = bounds[0].toInt();
+        int last = bounds.size() > 1 ? bounds[1].toInt() : first;
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+#endif
+
+CpuTopology detectTopology() {
+    CpuTopology topology;
+    topology.nodeCount = 1;
+#if defined(Q_OS_LINUX)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return topology;
+
+    std::vector<std::vector<int>> nodes;
+    QDir nodeDir("/sys/devices/system/node");
+    for (const QString& name : nodeDir.entryList(QStringList() << "node*", QDir::Dirs)) {
+        QFile list(nodeDir.filePath(name + "/cpulist"));
+        if (!list.open(QIODevice::ReadOnly)) continue;
+        std::vector<int> cpus;
+        for (int cpu : parseCpuList(QString::fromLatin1(list.readAll()))) {
+            if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+        }
+        if (!cpus.empty()) nodes.push_back(cpus);
+    }
+    if (nodes.empty()) { // No sysfs: one node with every allowed CPU
+        nodes.resize(1);
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) nodes[0].push_back(cpu);
+        }
+    }
+    topology.nodeCount = (int)nodes.size();
+    for (size_t i = 0; ; ++i) {
+        bool any = false;
+        for (const auto& node : nodes) {
+            if (i < node.size()) {
+                topology.pinOrder.push_back(node[i]);
+                any = true;
+            }
+        }
+        if (!any) break;
+    }
+#elif defined(Q_OS_WIN)
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+        for (int cpu = 0; cpu < (int)(8 * sizeof(DWORD_PTR)); ++cpu) {
+            if (processMask & ((DWORD_PTR)1 << cpu)) topology.pinOrder.push_back(cpu);
+        }
+    }
+#endif
+    return topology;
+}
+
+const CpuTopology& topology() {
+    static const CpuTopology detected = detectTopology(); // Thread-safe initialization
+    return detected;
+}
+
+std::atomic<int> g_nextWorker(0);
+thread_local bool t_pinned = false;
+
+bool pinCurrentThreadToCpu(int cpu) {
+#if defined(Q_OS_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(Q_OS_WIN)
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#else
+    Q_UNUSED(cpu);
+    return false;
+#endif
+}
+
+} // namespace
+
+void NumaPlacement::pinCurrentWorkerOnce() {
+    if (t_pinned) return;
+    t_pinned = true;
+    const std::vector<int>& order = topology().pinOrder;
+    if (order.empty()) return;
+    int worker = g_nextWorker.fetch_add(1, std::memory_order_relaxed);
+    pinCurrentThreadToCpu(order[worker % order.size()]);
+}
+
+int NumaPlacement::numaNodeCount() {
+    return topology().nodeCount;
+}
+
+QString NumaPlacement::describe() {
+    return QString("%1 NUMA node(s), %2 CPUs available for pinning")
+        .arg(topology().nodeCount)
+        .arg((int)topology().pinOrder.size());
+}
@@ -0,0 +1,46 @@
+#ifndef NUMAPLACEMENT_H
+#define NUMAPLACEMENT_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+// Optional thread and memory placement for multi-socket machines. Both are
+// off by default and only change where work and pages land, never results.
+//
+// Worker pinning: each pool thread binds itself to one CPU the first time it
+// runs a TaskGraph node (QThreadPool has no thread start hook). CPUs are
+// handed out round-robin across NUMA nodes, so a pool smaller than the
+// machine still spreads over every memory controller. Pinned pools should
+// not expire idle threads, or replacements take new CPUs.
+//
+// First-touch placement: Linux puts a page on the node of the thread that
+// first writes it. Buffers that are about to be overwritten are first
+// written by a worker team with the same static split the tasks use (see
+// resizeForOverwrite() in overwritevector.h), rather than by the single
+// thread that resized them.
+class NumaPlacement
+{
+public:
+    static void setPinWorkers(bool enabled) { s_pinWorkers.store(enabled, std::memory_order_relaxed); }
+    static bool pinWorkers() { return s_pinWorkers.load(std::memory_order_relaxed); }
+    static void setFirstTouch(bool enabled) { s_firstTouch.store(enabled, std::memory_order_relaxed); }
+    static bool firstTouch() { return s_firstTouch.load(std::memory_order_relaxed); }
+
+    // Binds the calling thread to its CPU if pinning is on and it is not
+    // bound yet. Cheap enough to call before every task.
+    static void pinCurrentWorker() {
+        if (pinWorkers()) pinCurrentWorkerOnce();
+    }
+
+    static int numaNodeCount();
+    static QString describe(); // For the log, e.g. "2 NUMA nodes, 32 CPUs"
+
+private:
+    static void pinCurrentWorkerOnce();
+
+    static std::atomic<bool> s_pinWorkers;
+    static std::atomic<bool> s_firstTouch;
+};
+
+#endif // NUMAPLACEMENT_H
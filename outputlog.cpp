@@ -0,0 +1,13 @@
+#include "outputlog.h"
+
+static OutputSink g_outputSink;
+
+void setOutputSink(OutputSink sink) {
+    g_outputSink = sink;
+}
+
+void appendToOutput(const QString& text) {
+    if (g_outputSink) {
+        g_outputSink(text);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef OUTPUTLOG_H
+#define OUTPUTLOG_H
+
+#include <QString>
+#include <functional>
+
+// Where workload progress text goes. The GUI routes it into its output view;
+// the headless benchmark discards it or sends it to stderr. Install the sink
+// before starting any work: it is read without locking.
+typedef std::function<void(const QString& text)> OutputSink;
+
+// Message verbosity. Levels above OUTPUT_LOG_MAX_LEVEL compile out: guard
+// messages built inside tasks with OUTPUT_LOG_ENABLED(level) so that neither
+// the string formatting nor the call survives. Build with
+// DEFINES += OUTPUT_LOG_MAX_LEVEL=2 to see per-task messages.
+enum OutputLogLevel {
+    LogError = 0,
+    LogInfo = 1,
+    LogDebug = 2  // Per-task detail, emitted from inside running tasks
+};
+
+#ifndef OUTPUT_LOG_MAX_LEVEL
+#define OUTPUT_LOG_MAX_LEVEL 1
+#endif
+#define OUTPUT_LOG_ENABLED(level) ((level) <= OUTPUT_LOG_MAX_LEVEL)
+
+void setOutputSink(OutputSink sink);
+
+// Thread-safe as long as the installed sink is.
+void appendToOutput(const QString& text);
+
+#endif // OUTPUTLOG_H
@@ -0,0 +1,75 @@
+#ifndef OVERWRITEVECTOR_H
+#define OVERWRITEVECTOR_H
+
+#include "asyncjob.h"
+#include "numaplacement.h"
+#include "workerteam.h"
+#include <QThreadPool>
+#include <QtGlobal>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// std::allocator, except that construct() with no value default-initializes
+// instead of value-initializing. resize() and the size constructor then
+// leave ints and other trivial elements as they are, without writing a
+// single page.
+template <typename T>
+class DefaultInitAllocator : public std::allocator<T>
+{
+public:
+    template <typename U>
+    struct rebind {
+        typedef DefaultInitAllocator<U> other;
+    };
+
+    DefaultInitAllocator() {}
+    template <typename U>
+    DefaultInitAllocator(const DefaultInitAllocator<U>&) {}
+
+    template <typename U>
+    void construct(U* p) {
+        ::new (static_cast<void*>(p)) U;
+    }
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
+// Buffers that are filled by parallel loops after they are sized: the sort
+// engines' data and scratch, Task 1's vector and Task 3's values.
+template <typename T>
+using OverwriteVector = std::vector<T, DefaultInitAllocator<T>>;
+
+// Resizes *vec for a caller that is about to overwrite every element; the
+// contents are unspecified afterwards. A reallocating resize neither copies
+// the old elements nor writes the new pages, so the first thread to write
+// a page decides its NUMA node. With first-touch placement on, a WorkerTeam
+// writes the new buffer first, each member one contiguous 1/members of it,
+// the same static split chunkRanges() gives the tasks that fill it later.
+// The team stays within the job's thread budget, like the job's loops.
+template <typename T>
+void resizeForOverwrite(OverwriteVector<T>* vec, size_t size, QThreadPool* pool, AsyncJob* job = nullptr) {
+    bool reallocates = size > vec->capacity();
+    if (reallocates) OverwriteVector<T>().swap(*vec); // Nothing in it is worth copying
+    vec->resize(size);
+    if (!reallocates || !NumaPlacement::firstTouch() || pool->maxThreadCount() == 0
+        || !std::is_trivially_copyable<T>::value) {
+        return;
+    }
+
+    T* base = vec->data();
+    WorkerTeam team(pool);
+    const int threads = pool->maxThreadCount();
+    team.run(job ? job->threadBudget(threads) : threads, [base, size](int member, int members) {
+        qint64 first = (qint64)size * member / members;
+        qint64 end = (qint64)size * (member + 1) / members;
+        std::memset(static_cast<void*>(base + first), 0, (size_t)(end - first) * sizeof(T));
+    });
+}
+
+#endif // OVERWRITEVECTOR_H
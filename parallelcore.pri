@@ -0,0 +1,47 @@
+# parallelcore.pri
+# Thread pool scheduling, sort engines and the demo workloads, shared by the
+# GUI application and the headless benchmark (bench/bench.pro).
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/asyncjob.cpp \
+    $$PWD/boundedvector.cpp \
+    $$PWD/jobscheduler.cpp \
+    $$PWD/logring.cpp \
+    $$PWD/numaplacement.cpp \
+    $$PWD/outputlog.cpp \
+    $$PWD/simddecrement.cpp \
+    $$PWD/simdsort.cpp \
+    $$PWD/stringmatrix.cpp \
+    $$PWD/stringsort.cpp \
+    $$PWD/taskgraph.cpp \
+    $$PWD/tasktrace.cpp \
+    $$PWD/workerteam.cpp \
+    $$PWD/workloads.cpp
+
+HEADERS += \
+    $$PWD/asyncjob.h \
+    $$PWD/boundedvector.h \
+    $$PWD/counterrng.h \
+    $$PWD/externalsort.h \
+    $$PWD/jobscheduler.h \
+    $$PWD/logring.h \
+    $$PWD/numaplacement.h \
+    $$PWD/outputlog.h \
+    $$PWD/overwritevector.h \
+    $$PWD/parallelfor.h \
+    $$PWD/parallelsort.h \
+    $$PWD/parallelverify.h \
+    $$PWD/simddecrement.h \
+    $$PWD/simdsort.h \
+    $$PWD/stringmatrix.h \
+    $$PWD/stringsort.h \
+    $$PWD/taskgraph.h \
+    $$PWD/tasktrace.h \
+    $$PWD/workerteam.h \
+    $$PWD/workloads.h
+
+# WaitOnAddress / WakeByAddressAll for the WorkerTeam barrier
+win32: LIBS += -lsynchronization
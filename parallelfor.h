@@ -0,0 +1,122 @@
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include "asyncjob.h"
+#include "taskgraph.h"
+#include "tasktrace.h"
+#include <QThreadPool>
+#include <QtGlobal>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Loops over an index range on a shared pool.
+//
+// The range is cut into blocks, and one claimer node per pool thread takes
+// the next unclaimed block from a shared counter until none are left. A
+// thread that finishes early just claims more blocks, so a slow block holds
+// the loop up by at most one block, and each block costs one atomic
+// increment instead of one heap-allocated QRunnable.
+//
+// Block boundaries depend only on the range and the grain, never on timing,
+// so parallelReduce() combines the same partials in the same order on every
+// run. Cancelling the job stops claimers at their next block.
+//
+// A job's loops start no more claimers than its thread budget (see
+// AsyncJob::threadBudget()), and claimers beyond a budget that shrinks
+// mid-loop, because another job was admitted, leave at their next block so
+// their threads go to the newcomer. Claimer 0 always stays, so the loop
+// finishes; a budget that grows applies from the next loop.
+
+// How a loop is cut into blocks: a fixed size, or automatic, which gives
+// each thread about BLOCKS_PER_THREAD blocks (enough to even out stragglers)
+// but never fewer than 'minimum' indices (enough work to amortize a claim).
+struct Grain {
+    static const int BLOCKS_PER_THREAD = 8;
+
+    qint64 size;    // Fixed block size, or 0 for automatic
+    qint64 minimum; // Smallest automatic block
+
+    static Grain automatic(qint64 minimum = 1) { return Grain{0, std::max<qint64>(1, minimum)}; }
+    static Grain fixed(qint64 size) { return Grain{std::max<qint64>(1, size), 1}; }
+
+    qint64 blockSize(qint64 count, int threads) const {
+        if (size > 0) return size;
+        qint64 blocks = (qint64)std::max(1, threads) * BLOCKS_PER_THREAD;
+        return std::max(minimum, (count + blocks - 1) / blocks);
+    }
+};
+
+// Smallest block of a loop doing a light pass over plain elements (fill,
+// copy, merge, decrement): below it a claim costs more than the work.
+const qint64 MIN_ELEMENT_GRAIN = 16 * 1024;
+
+// Calls body(blockBegin, blockEnd) for consecutive blocks covering [begin, end).
+// Each block is a trace event named 'traceName'.
+template <typename Body>
+void parallelFor(QThreadPool* pool, qint64 begin, qint64 end, Grain grain, const Body& body,
+                 AsyncJob* job = nullptr, const char* traceName = "parallelFor block") {
+    const qint64 count = end - begin;
+    if (count <= 0) return;
+    const int threads = pool->maxThreadCount();
+    const qint64 blockSize = grain.blockSize(count, threads);
+    const qint64 blocks = (count + blockSize - 1) / blockSize;
+
+    if (threads <= 0) { // No pool threads: run the blocks here rather than never
+        for (qint64 first = begin; first < end && !(job && job->isCancelled()); first += blockSize) {
+            body(first, std::min(first + blockSize, end));
+        }
+        return;
+    }
+
+    std::atomic<qint64> nextBlock(0);
+    std::atomic<qint64> blocksDone(0);
+    auto claimBlocks = [&](int claimer) {
+        for (;;) {
+            if (job && (job->isCancelled() || (claimer > 0 && claimer >= job->threadBudget(threads)))) return;
+            qint64 enqueuedNs = TaskTrace::isEnabled() ? TaskTrace::now() : 0;
+            qint64 block = nextBlock.fetch_add(1, std::memory_order_relaxed);
+            if (block >= blocks) return;
+            qint64 first = begin + block * blockSize;
+            qint64 startNs = enqueuedNs ? TaskTrace::now() : 0;
+            body(first, std::min(first + blockSize, end));
+            if (enqueuedNs) TaskTrace::record(traceName, enqueuedNs, startNs, TaskTrace::now());
+            qint64 done = blocksDone.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (job) job->updateProgress(done, blocks);
+        }
+    };
+
+    TaskGraph graph(pool, job);
+    graph.setReportsProgress(false); // Blocks report instead of claimers
+    int claimers = (int)std::min<qint64>(job ? job->threadBudget(threads) : threads, blocks);
+    for (int i = 0; i < claimers; ++i) {
+        graph.add([&claimBlocks, i]() { claimBlocks(i); }, std::vector<TaskGraph::NodeId>(), "parallelFor claimer");
+    }
+    graph.wait();
+}
+
+// Folds body(blockBegin, blockEnd) -> T over all blocks with combine(),
+// starting from 'identity', in block order.
+template <typename T, typename Body, typename Combine>
+T parallelReduce(QThreadPool* pool, qint64 begin, qint64 end, Grain grain, const T& identity,
+                 const Body& body, const Combine& combine, AsyncJob* job = nullptr,
+                 const char* traceName = "parallelReduce block") {
+    const qint64 count = end - begin;
+    if (count <= 0) return identity;
+    const qint64 blockSize = grain.blockSize(count, pool->maxThreadCount());
+    const qint64 blocks = (count + blockSize - 1) / blockSize;
+
+    std::vector<T> partial((size_t)blocks, identity);
+    parallelFor(pool, 0, blocks, Grain::fixed(1), [&](qint64 firstBlock, qint64 endBlock) {
+        for (qint64 b = firstBlock; b < endBlock; ++b) {
+            qint64 first = begin + b * blockSize;
+            partial[b] = body(first, std::min(first + blockSize, end));
+        }
+    }, job, traceName);
+
+    T result = identity;
+    for (const T& p : partial) result = combine(result, p);
+    return result;
+}
+
+#endif // PARALLELFOR_H
@@ -0,0 +1,949 @@
+#ifndef PARALLELSORT_H
+#define PARALLELSORT_H
+
+#include "asyncjob.h"
+#include "parallelfor.h"
+#include "outputlog.h"
+#include "overwritevector.h"
+#include "simdsort.h"
+#include "taskgraph.h"
+#include <QRunnable>
+#include <QString>
+#include <QThread>
+#include <QThreadPool>
+#include <QtGlobal>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Parallel sorting on a shared QThreadPool, templated on the element type and
+// comparator. Indices are qint64 throughout, so inputs are not limited to
+// 2^31 elements. Three engines are available:
+//
+//   MergeSort  - sort one chunk per thread, then a single parallel k-way merge
+//   RadixSort  - parallel LSD radix sort; needs a RadixKey for the element type
+//                and the natural ordering (falls back to MergeSort otherwise)
+//   SampleSort - splitter classification, then independent bucket sorts
+//
+// With setStable(true) all three keep equal elements in input order, which
+// together with KeyValue/KeyLess gives stable key-value sorting and argsort.
+// pipelinedSort() runs MergeSort with caller stages fused into its tasks.
+
+typedef std::function<void(const QString&)> SortLogger;
+
+// Run boundaries [start, end) of sorted chunks.
+typedef std::vector<std::pair<qint64, qint64>> RunList;
+
+// === Radix keys ===
+// RadixKey<T>::get() maps a value to an unsigned integer with the same order
+// as operator<, so the radix engine can sort it digit by digit.
+
+template <typename T, typename Enable = void>
+struct RadixKey {
+    static const bool available = false;
+};
+
+template <typename T>
+struct RadixKey<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+    static const bool available = true;
+    typedef typename std::make_unsigned<T>::type Bits;
+    static Bits get(T value) {
+        // Flipping the sign bit orders two's complement values as unsigned ones
+        return std::is_signed<T>::value ? (Bits)((Bits)value ^ ((Bits)1 << (sizeof(T) * 8 - 1))) : (Bits)value;
+    }
+};
+
+template <>
+struct RadixKey<float> {
+    static const bool available = true;
+    typedef quint32 Bits;
+    static Bits get(float value) {
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+};
+
+template <>
+struct RadixKey<double> {
+    static const bool available = true;
+    typedef quint64 Bits;
+    static Bits get(double value) {
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits & 0x8000000000000000ull) ? ~bits : (bits | 0x8000000000000000ull);
+    }
+};
+
+// A key with a payload (record id, row index, ...). Sorted with KeyLess, only
+// the key takes part in comparisons; use a stable sort to keep payloads with
+// equal keys in input order.
+template <typename K, typename V>
+struct KeyValue {
+    K key;
+    V value;
+};
+
+template <typename K, typename V>
+struct KeyLess {
+    bool operator()(const KeyValue<K, V>& a, const KeyValue<K, V>& b) const {
+        return a.key < b.key;
+    }
+};
+
+template <typename K, typename V>
+struct RadixKey<KeyValue<K, V>> {
+    static const bool available = RadixKey<K>::available;
+    typedef typename RadixKey<K>::Bits Bits;
+    static Bits get(const KeyValue<K, V>& kv) {
+        return RadixKey<K>::get(kv.key);
+    }
+};
+
+// The radix engine is only valid when the comparator is the order RadixKey encodes.
+template <typename T, typename Compare>
+struct RadixCompatible {
+    static const bool value = false;
+};
+
+template <typename T>
+struct RadixCompatible<T, std::less<T>> {
+    static const bool value = RadixKey<T>::available;
+};
+
+template <typename K, typename V>
+struct RadixCompatible<KeyValue<K, V>, KeyLess<K, V>> {
+    static const bool value = RadixKey<K>::available;
+};
+
+// Settings shared by every task of one sort call.
+template <typename Compare>
+struct SortContext {
+    Compare comp;
+    bool stable;
+    int corePercent; // Below 100, the sorter sleeps after each phase to cap core usage
+    SortLogger log;
+
+    void message(const QString& text) const {
+        if (log) log(text);
+    }
+
+    void throttle() const {
+        if (corePercent < 100) {
+            int delayMs = (100 - corePercent) * 2;
+            QThread::msleep(delayMs);
+        }
+    }
+};
+
+// Splits [0, size) into at most 'parts' contiguous ranges, the last one taking the remainder.
+inline RunList chunkRanges(qint64 size, int parts) {
+    RunList chunks;
+    qint64 chunkSize = (size > 0 && parts > 0) ? std::max<qint64>(1, size / parts) : 1;
+    for (int i = 0; i < parts; i++) {
+        qint64 start = i * chunkSize;
+        qint64 end = (i == parts - 1) ? size : (i + 1) * chunkSize;
+        if (start >= size) break;
+        end = std::min(end, size);
+        if (start >= end) continue;
+        chunks.push_back({start, end});
+    }
+    return chunks;
+}
+
+// Write offsets for one chunk of a parallel counting scatter, derived from the
+// shared histogram matrix: offset[b] = (all elements in smaller buckets) +
+// (elements of bucket b in earlier chunks). The scan is tiny, so every task
+// does its own and no serial prefix-sum phase is needed; the scatter is stable.
+inline std::vector<qint64> scatterOffsets(const std::vector<std::vector<qint64>>& histograms, int chunkIndex) {
+    const int numBuckets = histograms.empty() ? 0 : (int)histograms[0].size();
+    std::vector<qint64> offsets(numBuckets);
+    qint64 running = 0;
+    for (int b = 0; b < numBuckets; ++b) {
+        qint64 before = 0;
+        qint64 total = 0;
+        for (int c = 0; c < (int)histograms.size(); ++c) {
+            qint64 n = histograms[c][b];
+            if (c < chunkIndex) before += n;
+            total += n;
+        }
+        offsets[b] = running + before;
+        running += total;
+    }
+    return offsets;
+}
+
+// === Chunk sort and k-way merge ===
+
+// Sort and two-way merge primitives. int in natural order gets the
+// branch-free SIMD kernels (equal ints are indistinguishable, so they serve
+// stable sorts too); everything else uses the STL.
+template <typename T, typename Compare>
+struct SortKernel {
+    static void sort(T* begin, T* end, T* spare, const SortContext<Compare>& ctx) {
+        Q_UNUSED(spare);
+        if (ctx.stable) {
+            std::stable_sort(begin, end, ctx.comp);
+        } else {
+            std::sort(begin, end, ctx.comp);
+        }
+    }
+
+    static T* merge(const T* a, const T* aEnd, const T* b, const T* bEnd, T* out, const Compare& comp) {
+        return std::merge(a, aEnd, b, bEnd, out, comp);
+    }
+};
+
+template <>
+struct SortKernel<int, std::less<int>> {
+    static void sort(int* begin, int* end, int* spare, const SortContext<std::less<int>>&) {
+        simdSortInts(begin, end - begin, spare);
+    }
+
+    static int* merge(const int* a, const int* aEnd, const int* b, const int* bEnd, int* out, const std::less<int>&) {
+        return simdMergeInts(a, aEnd, b, bEnd, out);
+    }
+};
+
+// Sorts data[start, end). 'spare' is a vector of the same size whose
+// [start, end) range is free while the task runs; kernels that merge out of
+// place use it as their buffer.
+template <typename T, typename Compare>
+class SortTask : public QRunnable {
+private:
+    OverwriteVector<T>* data;
+    OverwriteVector<T>* spare;
+    qint64 startIndex;
+    qint64 endIndex;
+    int taskId;
+    const SortContext<Compare>* ctx;
+
+public:
+    SortTask(OverwriteVector<T>* vec, OverwriteVector<T>* spareVec, qint64 start, qint64 end, int id,
+             const SortContext<Compare>* context)
+        : data(vec), spare(spareVec), startIndex(start), endIndex(end), taskId(id), ctx(context) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        if (OUTPUT_LOG_ENABLED(LogDebug) && ctx->log) {
+            ctx->message(QString("[Thread %1] Task %2 sorting range [%3-%4)")
+                         .arg((quintptr)QThread::currentThreadId())
+                         .arg(taskId)
+                         .arg(startIndex)
+                         .arg(endIndex));
+        }
+
+        SortKernel<T, Compare>::sort(data->data() + startIndex, data->data() + endIndex,
+                                     spare->data() + startIndex, *ctx);
+
+        if (OUTPUT_LOG_ENABLED(LogDebug) && ctx->log) {
+            ctx->message(QString("[Thread %1] Task %2 completed sorting")
+                         .arg((quintptr)QThread::currentThreadId())
+                         .arg(taskId));
+        }
+    }
+};
+
+// A sorted run as a plain pointer range, so runs can live in one vector,
+// several vectors or memory-mapped files alike.
+template <typename T>
+struct SortedRun {
+    const T* begin;
+    const T* end;
+    qint64 size() const { return end - begin; }
+};
+
+// Position of element 'pos' of run 'runIndex' in the merged output. Ties are
+// ordered by run index, then by position, so every element has a unique rank
+// and the merge is stable.
+template <typename T, typename Compare>
+qint64 mergedRank(const std::vector<SortedRun<T>>& runs, int runIndex, qint64 pos, const Compare& comp) {
+    const T& value = runs[runIndex].begin[pos];
+    qint64 rank = pos;
+    for (int i = 0; i < (int)runs.size(); ++i) {
+        if (i == runIndex) continue;
+        const T* bound = (i < runIndex) ? std::upper_bound(runs[i].begin, runs[i].end, value, comp)
+                                        : std::lower_bound(runs[i].begin, runs[i].end, value, comp);
+        rank += bound - runs[i].begin;
+    }
+    return rank;
+}
+
+// Co-ranking: for every run, find how many of its elements belong to the
+// first 'rank' elements of the merged output. Each split is a binary search
+// over one run, so any output slice can be located without merging anything.
+template <typename T, typename Compare>
+std::vector<qint64> coRank(const std::vector<SortedRun<T>>& runs, qint64 rank, const Compare& comp) {
+    std::vector<qint64> splits(runs.size());
+    for (int j = 0; j < (int)runs.size(); ++j) {
+        qint64 lo = 0;
+        qint64 hi = runs[j].size();
+        while (lo < hi) {
+            qint64 mid = lo + (hi - lo) / 2;
+            if (mergedRank(runs, j, mid, comp) < rank) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        splits[j] = lo;
+    }
+    return splits;
+}
+
+// Merges runs[j][cursor[j], limit[j]) for all j into 'out', using the same
+// tie order as coRank(), and returns the end of the output.
+template <typename T, typename Compare>
+T* kWayMerge(const std::vector<SortedRun<T>>& runs, std::vector<qint64> cursor, const std::vector<qint64>& limit,
+             const Compare& comp, T* out) {
+    // Min-heap of run indices keyed by each run's current head; ties go
+    // to the lower run index.
+    auto later = [&](int a, int b) {
+        const T& x = runs[a].begin[cursor[a]];
+        const T& y = runs[b].begin[cursor[b]];
+        return comp(y, x) || (!comp(x, y) && a > b);
+    };
+    std::vector<int> heap;
+    heap.reserve(runs.size());
+    for (int j = 0; j < (int)runs.size(); ++j) {
+        if (cursor[j] < limit[j]) heap.push_back(j);
+    }
+    std::make_heap(heap.begin(), heap.end(), later);
+
+    while (heap.size() > 2) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        int run = heap.back();
+        *out++ = runs[run].begin[cursor[run]];
+        if (++cursor[run] < limit[run]) {
+            std::push_heap(heap.begin(), heap.end(), later);
+        } else {
+            heap.pop_back();
+        }
+    }
+
+    // Finish the last two (or one) runs without the heap; the two-way merge
+    // keeps the lower run index first on ties.
+    if (heap.size() == 2) {
+        int a = std::min(heap[0], heap[1]);
+        int b = std::max(heap[0], heap[1]);
+        out = SortKernel<T, Compare>::merge(runs[a].begin + cursor[a], runs[a].begin + limit[a],
+                                            runs[b].begin + cursor[b], runs[b].begin + limit[b], out, comp);
+    } else if (heap.size() == 1) {
+        int a = heap[0];
+        out = std::copy(runs[a].begin + cursor[a], runs[a].begin + limit[a], out);
+    }
+    return out;
+}
+
+template <typename T, typename Compare>
+class MergeTask : public QRunnable {
+private:
+    const OverwriteVector<T>* source;
+    OverwriteVector<T>* target;
+    const RunList* runs;
+    qint64 outStart, outEnd;
+    int taskId;
+    const SortContext<Compare>* ctx;
+
+public:
+    MergeTask(const OverwriteVector<T>* src, OverwriteVector<T>* dst, const RunList* sortedRuns, qint64 outS, qint64 outE, int id,
+              const SortContext<Compare>* context)
+        : source(src), target(dst), runs(sortedRuns), outStart(outS), outEnd(outE), taskId(id), ctx(context) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        if (OUTPUT_LOG_ENABLED(LogDebug) && ctx->log) {
+            ctx->message(QString("[Thread %1] Merge Task %2 merging output range [%3-%4) from %5 runs")
+                         .arg((quintptr)QThread::currentThreadId())
+                         .arg(taskId)
+                         .arg(outStart)
+                         .arg(outEnd)
+                         .arg(runs->size()));
+        }
+
+        std::vector<SortedRun<T>> spans;
+        for (const auto& r : *runs) {
+            spans.push_back({source->data() + r.first, source->data() + r.second});
+        }
+        std::vector<qint64> cursor = coRank(spans, outStart, ctx->comp);
+        std::vector<qint64> limit = coRank(spans, outEnd, ctx->comp);
+        kWayMerge(spans, cursor, limit, ctx->comp, target->data() + outStart);
+
+        if (OUTPUT_LOG_ENABLED(LogDebug) && ctx->log) {
+            ctx->message(QString("[Thread %1] Merge Task %2 completed")
+                         .arg((quintptr)QThread::currentThreadId())
+                         .arg(taskId));
+        }
+    }
+};
+
+// === LSD radix sort tasks ===
+// Keys are sorted as (RadixKey - minKey) so the digit count follows the
+// observed range rather than the full key width.
+
+template <typename T>
+class KeyRangeTask : public QRunnable {
+public:
+    typedef typename RadixKey<T>::Bits Bits;
+
+private:
+    const OverwriteVector<T>* data;
+    qint64 startIndex;
+    qint64 endIndex;
+    std::pair<Bits, Bits>* result; // (min, max) key of this chunk
+
+public:
+    KeyRangeTask(const OverwriteVector<T>* vec, qint64 start, qint64 end, std::pair<Bits, Bits>* out)
+        : data(vec), startIndex(start), endIndex(end), result(out) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        Bits lo = RadixKey<T>::get((*data)[startIndex]);
+        Bits hi = lo;
+        for (qint64 i = startIndex + 1; i < endIndex; ++i) {
+            Bits key = RadixKey<T>::get((*data)[i]);
+            lo = std::min(lo, key);
+            hi = std::max(hi, key);
+        }
+        *result = {lo, hi};
+    }
+};
+
+template <typename T>
+class RadixHistogramTask : public QRunnable {
+public:
+    typedef typename RadixKey<T>::Bits Bits;
+
+private:
+    const OverwriteVector<T>* data;
+    qint64 startIndex;
+    qint64 endIndex;
+    Bits minKey;
+    int shift;
+    Bits mask;
+    std::vector<qint64>* counts; // this chunk's row of the histogram matrix
+
+public:
+    RadixHistogramTask(const OverwriteVector<T>* vec, qint64 start, qint64 end, Bits minK, int sh, Bits m, std::vector<qint64>* out)
+        : data(vec), startIndex(start), endIndex(end), minKey(minK), shift(sh), mask(m), counts(out) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        std::fill(counts->begin(), counts->end(), 0);
+        for (qint64 i = startIndex; i < endIndex; ++i) {
+            Bits key = (Bits)(RadixKey<T>::get((*data)[i]) - minKey);
+            (*counts)[(key >> shift) & mask]++;
+        }
+    }
+};
+
+template <typename T>
+class RadixScatterTask : public QRunnable {
+public:
+    typedef typename RadixKey<T>::Bits Bits;
+
+private:
+    const OverwriteVector<T>* source;
+    OverwriteVector<T>* target;
+    const std::vector<std::vector<qint64>>* histograms;
+    int chunkIndex;
+    qint64 startIndex;
+    qint64 endIndex;
+    Bits minKey;
+    int shift;
+    Bits mask;
+
+public:
+    RadixScatterTask(const OverwriteVector<T>* src, OverwriteVector<T>* dst, const std::vector<std::vector<qint64>>* hist,
+                     int chunk, qint64 start, qint64 end, Bits minK, int sh, Bits m)
+        : source(src), target(dst), histograms(hist), chunkIndex(chunk), startIndex(start), endIndex(end),
+          minKey(minK), shift(sh), mask(m) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        std::vector<qint64> offsets = scatterOffsets(*histograms, chunkIndex);
+
+        for (qint64 i = startIndex; i < endIndex; ++i) {
+            const T& value = (*source)[i];
+            Bits key = (Bits)(RadixKey<T>::get(value) - minKey);
+            (*target)[offsets[(key >> shift) & mask]++] = value;
+        }
+    }
+};
+
+// === Samplesort tasks ===
+// Elements are classified against sorted, distinct splitters into a few
+// buckets per thread, scattered so each bucket is contiguous, and every
+// bucket is then sorted on its own. Bucket 2i holds keys in
+// [splitter[i-1], splitter[i]). A splitter that was sampled more than once
+// marks a heavy key: its equal keys go to bucket 2i+1 instead, which is
+// sorted as soon as it is scattered. Other odd buckets stay empty.
+
+template <typename T, typename Compare>
+class SampleClassifyTask : public QRunnable {
+private:
+    const OverwriteVector<T>* data;
+    qint64 startIndex;
+    qint64 endIndex;
+    const std::vector<T>* splitters;
+    const std::vector<char>* heavy;        // per splitter: its equal keys get their own bucket
+    OverwriteVector<unsigned short>* bucketOf; // per element, reused by the scatter
+    std::vector<qint64>* counts;
+    const SortContext<Compare>* ctx;
+
+public:
+    SampleClassifyTask(const OverwriteVector<T>* vec, qint64 start, qint64 end, const std::vector<T>* split,
+                       const std::vector<char>* heavyKeys, OverwriteVector<unsigned short>* oracle,
+                       std::vector<qint64>* out, const SortContext<Compare>* context)
+        : data(vec), startIndex(start), endIndex(end), splitters(split), heavy(heavyKeys), bucketOf(oracle),
+          counts(out), ctx(context) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        std::fill(counts->begin(), counts->end(), 0);
+        for (qint64 i = startIndex; i < endIndex; ++i) {
+            const T& value = (*data)[i];
+            int range = std::upper_bound(splitters->begin(), splitters->end(), value, ctx->comp) - splitters->begin();
+            // upper_bound puts keys equal to splitter[range-1] in this range.
+            int bucket = 2 * range;
+            if (range > 0 && (*heavy)[range - 1] && !ctx->comp((*splitters)[range - 1], value)) bucket = 2 * range - 1;
+            (*bucketOf)[i] = (unsigned short)bucket;
+            (*counts)[bucket]++;
+        }
+    }
+};
+
+template <typename T>
+class SampleScatterTask : public QRunnable {
+private:
+    const OverwriteVector<T>* source;
+    OverwriteVector<T>* target;
+    const OverwriteVector<unsigned short>* bucketOf;
+    const std::vector<std::vector<qint64>>* histograms;
+    int chunkIndex;
+    qint64 startIndex;
+    qint64 endIndex;
+
+public:
+    SampleScatterTask(const OverwriteVector<T>* src, OverwriteVector<T>* dst, const OverwriteVector<unsigned short>* oracle,
+                      const std::vector<std::vector<qint64>>* hist, int chunk, qint64 start, qint64 end)
+        : source(src), target(dst), bucketOf(oracle), histograms(hist), chunkIndex(chunk), startIndex(start), endIndex(end) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        std::vector<qint64> offsets = scatterOffsets(*histograms, chunkIndex);
+        for (qint64 i = startIndex; i < endIndex; ++i) {
+            (*target)[offsets[(*bucketOf)[i]]++] = (*source)[i];
+        }
+    }
+};
+
+// === ParallelSorter ===
+
+template <typename T, typename Compare = std::less<T>>
+class ParallelSorter {
+public:
+    enum SortMode {
+        MergeSort, // chunk sort, then one parallel k-way merge
+        RadixSort, // parallel LSD radix sort, RadixKey types with natural order only
+        SampleSort // splitter classification, then independent bucket sorts
+    };
+
+private:
+    QThreadPool* m_pool;    // Declared first
+    OverwriteVector<T>* data; // Vector being sorted by the current parallelSort() call
+    SortMode m_mode;
+    AsyncJob* m_job;        // Cancellation and progress for the current call, may be null
+    SortContext<Compare> m_ctx;
+
+    // Owned scratch space, kept across runs so repeated sorts of the same size
+    // never reallocate or page-fault. Every mode writes its last pass into
+    // m_scratch and swaps it with *data, so there is no copy-back either.
+    OverwriteVector<T> m_scratch;
+    OverwriteVector<unsigned short> m_bucketOf; // samplesort classification oracle
+
+    static const int MAX_RADIX_BITS = 11; // 2048 buckets per chunk histogram stays cache resident
+    static const int SAMPLES_PER_BUCKET = 32;  // oversampling keeps bucket sizes within a few percent
+    static const int BUCKETS_PER_THREAD = 4;   // spare buckets absorb the one that comes out large
+    static const int PIPELINE_BLOCK_BYTES = 128 * 1024;    // pipelinedSort() blocks stay in L2 from produce to sort
+    static const int PIPELINE_SLICE_BYTES = 1024 * 1024;   // pipelinedSort() merge slices stay cached until consumed
+
+public:
+    // Initializer list order matches declaration order
+    explicit ParallelSorter(QThreadPool* pool, Compare comp = Compare())
+        : m_pool(pool), data(nullptr), m_mode(MergeSort), m_job(nullptr) {
+        m_ctx.comp = comp;
+        m_ctx.stable = false;
+        m_ctx.corePercent = 100;
+    }
+
+    static bool supportsRadix() { return RadixCompatible<T, Compare>::value; }
+
+    void setLogger(SortLogger logger) { m_ctx.log = logger; }
+    void setStable(bool stable) { m_ctx.stable = stable; }
+    void setCoreUtilization(int percent) { m_ctx.corePercent = percent; }
+
+    void parallelSort(OverwriteVector<T>* vec, SortMode mode = MergeSort, AsyncJob* job = nullptr) {
+        if (!beginSort(vec, mode, job, mode == RadixSort ? "LSD radix sort"
+                                       : mode == SampleSort ? "samplesort"
+                                       : "chunk sort + k-way merge")) {
+            return;
+        }
+        if (m_mode == RadixSort) {
+            radixSort(std::integral_constant<bool, RadixCompatible<T, Compare>::value>());
+        } else if (m_mode == SampleSort) {
+            sampleSort();
+        } else {
+            mergeSort();
+        }
+        endSort();
+    }
+
+    // Stages that pipelinedSort() runs inside its own tasks.
+    typedef std::function<void(T* begin, T* end, qint64 firstIndex)> BlockProducer;
+    typedef std::function<void(const T* begin, const T* end, qint64 firstIndex)> SliceConsumer;
+
+    // MergeSort of data that is produced and consumed as part of the sort,
+    // so a generate, sort and verify flow does not stream the whole vector
+    // through memory once per phase. *vec keeps its size; its contents are
+    // replaced. Each run's worker fills the run through produce() one
+    // PIPELINE_BLOCK_BYTES block at a time, sorting each block right after
+    // it is filled, and then merges the blocks. Each merge slice goes to
+    // consume() from the worker that has just written it. consume() sees
+    // every output element exactly once, in slices of unspecified order;
+    // neither stage may touch elements outside the range it is given.
+    void pipelinedSort(OverwriteVector<T>* vec, const BlockProducer& produce, const SliceConsumer& consume,
+                       AsyncJob* job = nullptr) {
+        if (!beginSort(vec, MergeSort, job, "pipelined produce + chunk sort + k-way merge")) return;
+        pipelinedMergeSort(produce, consume);
+        endSort();
+    }
+
+private:
+    // Shared setup of the entry points; false if the pool cannot sort.
+    bool beginSort(OverwriteVector<T>* vec, SortMode mode, AsyncJob* job, const char* modeName) {
+        data = vec;
+        m_mode = mode;
+        m_job = job;
+        m_ctx.message(QString("ParallelSorter using shared pool with max %1 threads.").arg(m_pool->maxThreadCount()));
+        m_ctx.message(QString("Sort mode: %1%2").arg(modeName).arg(m_ctx.stable ? " (stable)" : ""));
+        m_ctx.message(QString("Core utilization set to %1%").arg(m_ctx.corePercent));
+        m_ctx.message(QString("Main thread ID: %1").arg((quintptr)QThread::currentThreadId()));
+
+        if (m_pool->maxThreadCount() == 0) {
+            m_ctx.message("Error: Thread pool has 0 max threads. Cannot sort.");
+            return false;
+        }
+        if (m_scratch.size() != data->size()) {
+            m_ctx.message(QString("Resizing scratch buffer to %1 elements").arg((qint64)data->size()));
+            resizeForOverwrite(&m_scratch, data->size(), m_pool, m_job);
+        }
+        return true;
+    }
+
+    void endSort() {
+        if (m_job && m_job->isCancelled()) {
+            m_ctx.message("=== Sorting cancelled ===");
+            return;
+        }
+        m_ctx.message("=== Sorting complete! ===");
+    }
+
+    void beginPhase(const QString& phase) {
+        if (m_job) m_job->beginPhase(phase);
+    }
+
+    void mergeSort() {
+        beginPhase("Sorting chunks");
+        qint64 vectorSize = data->size();
+        int numThreads = m_pool->maxThreadCount();
+        qint64 chunkSize = (vectorSize > 0 && numThreads > 0) ? std::max<qint64>(1, vectorSize / numThreads) : 1;
+
+        m_ctx.message("=== PHASE 1: Sorting chunks in parallel ===");
+        m_ctx.message(QString("Vector size: %1").arg(vectorSize));
+        m_ctx.message(QString("Chunk size: %1 (numThreads: %2)").arg(chunkSize).arg(numThreads));
+
+        // One run per thread: more runs would only widen the merge.
+        RunList chunks = chunkRanges(vectorSize, numThreads);
+        parallelFor(m_pool, 0, (qint64)chunks.size(), Grain::fixed(1), [this, &chunks](qint64 first, qint64 end) {
+            for (qint64 i = first; i < end; ++i) {
+                SortTask<T, Compare>(data, &m_scratch, chunks[i].first, chunks[i].second, (int)i, &m_ctx).run();
+            }
+        }, m_job, "SortTask");
+        m_ctx.throttle();
+        if (chunks.size() < 2 || (m_job && m_job->isCancelled())) return;
+
+        // One k-way merge pass: the output is cut into slices merged
+        // independently from all runs. Slices are cheap to cut (two
+        // co-ranks each), so there are several per thread and a slow one
+        // does not hold up the rest.
+        beginPhase("K-way merging");
+        m_ctx.message("=== PHASE 2: K-way merging sorted chunks ===");
+        parallelFor(m_pool, 0, vectorSize, Grain::automatic(MIN_ELEMENT_GRAIN), [this, &chunks](qint64 first, qint64 end) {
+            MergeTask<T, Compare>(data, &m_scratch, &chunks, first, end, (int)(first / MIN_ELEMENT_GRAIN), &m_ctx).run();
+        }, m_job, "MergeTask");
+        m_ctx.throttle(); // Once per phase: there are several slices per thread
+        data->swap(m_scratch);
+    }
+
+    void pipelinedMergeSort(const BlockProducer& produce, const SliceConsumer& consume) {
+        beginPhase("Producing and sorting runs");
+        qint64 vectorSize = data->size();
+        int numThreads = m_pool->maxThreadCount();
+        qint64 blockSize = std::max<qint64>(1, PIPELINE_BLOCK_BYTES / (qint64)sizeof(T));
+
+        m_ctx.message("=== PHASE 1: Producing and sorting runs in parallel ===");
+        m_ctx.message(QString("Vector size: %1").arg(vectorSize));
+        m_ctx.message(QString("Block size: %1 (numThreads: %2)").arg(blockSize).arg(numThreads));
+
+        // One run per thread, as in mergeSort(). Each block is produced and
+        // sorted while it is in L2, so only the merge rounds above block
+        // size stream the run through memory.
+        RunList runs = chunkRanges(vectorSize, numThreads);
+        const bool singleRun = runs.size() < 2;
+        parallelFor(m_pool, 0, (qint64)runs.size(), Grain::fixed(1),
+                    [this, &runs, &produce, &consume, blockSize, singleRun](qint64 first, qint64 end) {
+            for (qint64 i = first; i < end; ++i) {
+                qint64 start = runs[i].first;
+                qint64 size = runs[i].second - start;
+                T* run = data->data() + start;
+                T* spare = m_scratch.data() + start;
+
+                // An odd number of merge rounds starts from the spare copy so
+                // the last round lands back in the run.
+                int rounds = 0;
+                for (qint64 width = blockSize; width < size; width *= 2) rounds++;
+                const bool startInSpare = rounds % 2 == 1;
+                for (qint64 block = 0; block < size; block += blockSize) {
+                    qint64 blockEnd = std::min(block + blockSize, size);
+                    produce(run + block, run + blockEnd, start + block);
+                    SortKernel<T, Compare>::sort(run + block, run + blockEnd, spare + block, m_ctx);
+                    if (startInSpare) std::copy(run + block, run + blockEnd, spare + block);
+                }
+                T* from = startInSpare ? spare : run;
+                T* to = startInSpare ? run : spare;
+                for (qint64 width = blockSize; width < size; width *= 2) {
+                    for (qint64 lo = 0; lo < size; lo += 2 * width) {
+                        qint64 mid = std::min(lo + width, size);
+                        qint64 hi = std::min(lo + 2 * width, size);
+                        SortKernel<T, Compare>::merge(from + lo, from + mid, from + mid, from + hi, to + lo, m_ctx.comp);
+                    }
+                    std::swap(from, to);
+                }
+                if (singleRun) consume(run, run + size, start);
+            }
+        }, m_job, "Pipelined SortTask");
+        m_ctx.throttle();
+        if (singleRun || (m_job && m_job->isCancelled())) return;
+
+        // As in mergeSort(), but slices are capped at PIPELINE_SLICE_BYTES so
+        // consume() reads back what the merge has just left in cache.
+        beginPhase("K-way merging");
+        m_ctx.message("=== PHASE 2: K-way merging sorted runs ===");
+        qint64 sliceSize = std::min(Grain::automatic(MIN_ELEMENT_GRAIN).blockSize(vectorSize, numThreads),
+                                    std::max<qint64>(MIN_ELEMENT_GRAIN, PIPELINE_SLICE_BYTES / (qint64)sizeof(T)));
+        parallelFor(m_pool, 0, vectorSize, Grain::fixed(sliceSize), [this, &runs, &consume, sliceSize](qint64 first, qint64 end) {
+            MergeTask<T, Compare>(data, &m_scratch, &runs, first, end, (int)(first / sliceSize), &m_ctx).run();
+            consume(m_scratch.data() + first, m_scratch.data() + end, first);
+        }, m_job, "Pipelined MergeTask");
+        m_ctx.throttle();
+        data->swap(m_scratch);
+    }
+
+    void radixSort(std::false_type) {
+        m_ctx.message("Radix sort needs a RadixKey type sorted by its natural order; using k-way merge sort instead.");
+        mergeSort();
+    }
+
+    void radixSort(std::true_type) {
+        typedef typename RadixKey<T>::Bits Bits;
+        const int keyWidth = (int)sizeof(Bits) * 8;
+
+        qint64 vectorSize = data->size();
+        int numThreads = m_pool->maxThreadCount();
+        RunList chunks = chunkRanges(vectorSize, numThreads);
+        if (chunks.empty()) return;
+
+        // The digit plan depends on the key range, so this short scan is the
+        // only point where the caller waits before the passes are scheduled.
+        beginPhase("Scanning key range");
+        m_ctx.message("=== PHASE 1: Scanning key range ===");
+        std::vector<std::pair<Bits, Bits>> chunkRange(chunks.size());
+        {
+            TaskGraph scan(m_pool, m_job);
+            for (int i = 0; i < (int)chunks.size(); ++i) {
+                scan.add(new KeyRangeTask<T>(data, chunks[i].first, chunks[i].second, &chunkRange[i]));
+            }
+        }
+        if (m_job && m_job->isCancelled()) return;
+
+        Bits minKey = chunkRange[0].first;
+        Bits maxKey = chunkRange[0].second;
+        for (const auto& r : chunkRange) {
+            minKey = std::min(minKey, r.first);
+            maxKey = std::max(maxKey, r.second);
+        }
+        Bits span = (Bits)(maxKey - minKey);
+        int keyBits = 0;
+        while (keyBits < keyWidth && (span >> keyBits) != 0) keyBits++;
+        if (keyBits == 0) {
+            m_ctx.message("All keys are equal; nothing to sort.");
+            return;
+        }
+        int passes = (keyBits + MAX_RADIX_BITS - 1) / MAX_RADIX_BITS;
+        int digitBits = (keyBits + passes - 1) / passes;
+        Bits mask = (Bits)(((Bits)1 << digitBits) - 1);
+        m_ctx.message(QString("Key span %1: %2 bits -> %3 passes of %4-bit digits")
+                      .arg((quint64)span).arg(keyBits).arg(passes).arg(digitBits));
+
+        beginPhase(QString("Radix sorting (%1 passes)").arg(passes));
+        // Each pass reads 'source' and writes 'target'; the buffers trade
+        // places between passes and *data is fixed up once at the end.
+        TaskGraph graph(m_pool, m_job);
+        OverwriteVector<T>* source = data;
+        OverwriteVector<T>* target = &m_scratch;
+        std::vector<std::vector<qint64>> histograms(chunks.size(), std::vector<qint64>((size_t)mask + 1));
+        std::vector<TaskGraph::NodeId> scatters;
+        for (int pass = 0; pass < passes; ++pass) {
+            int shift = pass * digitBits;
+            m_ctx.message(QString("=== PASS %1: digit bits [%2-%3) ===").arg(pass + 1).arg(shift).arg(shift + digitBits));
+            std::vector<TaskGraph::NodeId> counts;
+            for (int i = 0; i < (int)chunks.size(); ++i) {
+                counts.push_back(graph.add(new RadixHistogramTask<T>(source, chunks[i].first, chunks[i].second,
+                                                                     minKey, shift, mask, &histograms[i]),
+                                           scatters));
+            }
+            scatters.clear();
+            for (int i = 0; i < (int)chunks.size(); ++i) {
+                scatters.push_back(graph.add(new RadixScatterTask<T>(source, target, &histograms, i, chunks[i].first, chunks[i].second,
+                                                                     minKey, shift, mask),
+                                             counts));
+            }
+            std::swap(source, target);
+        }
+        graph.wait();
+        if (source != data) {
+            data->swap(m_scratch);
+        }
+    }
+
+    void sampleSort() {
+        qint64 vectorSize = data->size();
+        int numThreads = m_pool->maxThreadCount();
+        RunList chunks = chunkRanges(vectorSize, numThreads);
+        if (chunks.size() < 2) {
+            SortTask<T, Compare>(data, &m_scratch, 0, vectorSize, 0, &m_ctx).run();
+            m_ctx.throttle();
+            return;
+        }
+
+        m_ctx.message("=== PHASE 1: Sampling splitters ===");
+        int numBuckets = (int)chunks.size() * BUCKETS_PER_THREAD;
+        qint64 numSamples = std::min<qint64>(vectorSize, (qint64)numBuckets * SAMPLES_PER_BUCKET);
+        std::vector<T> samples;
+        samples.reserve(numSamples);
+        std::mt19937_64 gen(12345); // fixed seed: splitter choice does not need to vary between runs
+        std::uniform_int_distribution<qint64> pick(0, vectorSize - 1);
+        for (qint64 i = 0; i < numSamples; ++i) {
+            samples.push_back((*data)[pick(gen)]);
+        }
+        std::sort(samples.begin(), samples.end(), m_ctx.comp);
+        // Runs of equal splitters collapse into one heavy splitter, so a
+        // frequent key fills one equality bucket instead of several range
+        // buckets that would all need sorting.
+        std::vector<T> splitters;
+        std::vector<char> heavy;
+        for (int b = 1; b < numBuckets; ++b) {
+            const T& splitter = samples[b * numSamples / numBuckets];
+            if (!splitters.empty() && !m_ctx.comp(splitters.back(), splitter)) {
+                heavy.back() = 1;
+            } else {
+                splitters.push_back(splitter);
+                heavy.push_back(0);
+            }
+        }
+        int numHeavy = (int)std::count(heavy.begin(), heavy.end(), 1);
+        numBuckets = 2 * (int)splitters.size() + 1;
+        m_ctx.message(QString("%1 splitters (%2 heavy) from %3 samples").arg(splitters.size()).arg(numHeavy).arg(numSamples));
+
+        beginPhase("Classifying and sorting buckets");
+        m_ctx.message("=== PHASE 2: Classifying elements into buckets ===");
+        TaskGraph graph(m_pool, m_job);
+        resizeForOverwrite(&m_bucketOf, (size_t)vectorSize, m_pool, m_job);
+        std::vector<std::vector<qint64>> histograms(chunks.size(), std::vector<qint64>(numBuckets));
+        std::vector<TaskGraph::NodeId> classified;
+        for (int i = 0; i < (int)chunks.size(); ++i) {
+            classified.push_back(graph.add(new SampleClassifyTask<T, Compare>(data, chunks[i].first, chunks[i].second,
+                                                                              &splitters, &heavy, &m_bucketOf, &histograms[i], &m_ctx)));
+        }
+
+        for (int i = 0; i < (int)chunks.size(); ++i) {
+            graph.add(new SampleScatterTask<T>(data, &m_scratch, &m_bucketOf, &histograms, i,
+                                               chunks[i].first, chunks[i].second),
+                      classified);
+        }
+
+        graph.wait();
+        if (m_job && m_job->isCancelled()) return;
+
+        // Buckets are already in global order, so once each one is sorted the
+        // whole buffer is sorted: no merge phase follows. There are several
+        // buckets per thread, claimed one at a time, so an oversized bucket
+        // is absorbed by the others rather than setting the phase's length.
+        // Equality buckets (odd) hold one key and are left as scattered,
+        // which also keeps them stable.
+        m_ctx.message("=== PHASE 3: Sorting buckets independently ===");
+        std::vector<qint64> bucketStart(numBuckets + 1, 0);
+        for (int b = 0; b < numBuckets; ++b) {
+            bucketStart[b + 1] = bucketStart[b];
+            for (const auto& h : histograms) bucketStart[b + 1] += h[b];
+        }
+        OverwriteVector<T>* buffer = &m_scratch;
+        OverwriteVector<T>* spare = data; // Fully scattered out before any bucket sort starts
+        parallelFor(m_pool, 0, numBuckets, Grain::fixed(1), [this, buffer, spare, &bucketStart](qint64 first, qint64 end) {
+            for (qint64 b = first; b < end; ++b) {
+                if (b % 2 == 0 && bucketStart[b + 1] > bucketStart[b]) {
+                    SortTask<T, Compare>(buffer, spare, bucketStart[b], bucketStart[b + 1], (int)b, &m_ctx).run();
+                }
+            }
+        }, m_job, "Samplesort bucket SortTask");
+        m_ctx.throttle();
+        data->swap(m_scratch);
+    }
+};
+
+// Returns the permutation that sorts 'keys': keys[order[0]] <= keys[order[1]] <= ...
+// Keys and their indices are sorted together as KeyValue records, so radix
+// keys take the radix engine. Stable by default, so equal keys keep index order.
+template <typename K>
+std::vector<qint64> parallelArgsort(const std::vector<K>& keys, QThreadPool* pool, bool stable = true, AsyncJob* job = nullptr) {
+    typedef KeyValue<K, qint64> Record;
+    OverwriteVector<Record> records(keys.size());
+    for (qint64 i = 0; i < (qint64)keys.size(); ++i) {
+        records[i].key = keys[i];
+        records[i].value = i;
+    }
+
+    ParallelSorter<Record, KeyLess<K, qint64>> sorter(pool);
+    sorter.setStable(stable);
+    typedef ParallelSorter<Record, KeyLess<K, qint64>> Sorter;
+    sorter.parallelSort(&records, Sorter::supportsRadix() ? Sorter::RadixSort : Sorter::MergeSort, job);
+
+    std::vector<qint64> order(records.size());
+    for (qint64 i = 0; i < (qint64)records.size(); ++i) {
+        order[i] = records[i].value;
+    }
+    return order;
+}
+
+#endif // PARALLELSORT_H
@@ -0,0 +1,199 @@
+#ifndef PARALLELVERIFY_H
+#define PARALLELVERIFY_H
+
+#include "asyncjob.h"
+#include "counterrng.h"
+#include "parallelfor.h"
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QtGlobal>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+// Output checks that run on the shared pool, so they can stay enabled after
+// every sort: one parallelFor pass, with an early exit shared across blocks
+// once any of them finds a violation.
+//
+// A sort is correct when its output is ordered and is a permutation of its
+// input. Order is checked pairwise, including the pairs that straddle chunk
+// boundaries; the permutation property via an order-independent multiset
+// digest taken before and after.
+
+// Ranges are scanned in blocks of this many elements between checks of the
+// shared early-exit flag; also the smallest parallelFor block.
+const qint64 VERIFY_BLOCK = 64 * 1024;
+
+// Hash of one element's bytes. Only meaningful for types without padding.
+template <typename T>
+quint64 elementHash(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "elementHash reads the value's bytes");
+    const uchar* bytes = reinterpret_cast<const uchar*>(&value);
+    quint64 h = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < sizeof(T); i += 8) {
+        quint64 word = 0;
+        std::memcpy(&word, bytes + i, std::min<size_t>(8, sizeof(T) - i));
+        h = mixBits64(h ^ word);
+    }
+    return h;
+}
+
+// Sum of element hashes modulo 2^64, plus the element count. Addition makes
+// the digest independent of element order, and digests of disjoint parts
+// add up to the digest of the whole.
+struct MultisetDigest {
+    quint64 hashSum;
+    qint64 count;
+
+    MultisetDigest() : hashSum(0), count(0) {}
+
+    MultisetDigest& operator+=(const MultisetDigest& other) {
+        hashSum += other.hashSum;
+        count += other.count;
+        return *this;
+    }
+    bool operator==(const MultisetDigest& other) const {
+        return hashSum == other.hashSum && count == other.count;
+    }
+    bool operator!=(const MultisetDigest& other) const { return !(*this == other); }
+};
+
+template <typename T>
+MultisetDigest multisetDigest(const T* begin, const T* end) {
+    MultisetDigest d;
+    for (const T* p = begin; p != end; ++p) {
+        d.hashSum += elementHash(*p);
+    }
+    d.count = end - begin;
+    return d;
+}
+
+template <typename T>
+MultisetDigest parallelMultisetDigest(const T* data, qint64 size, QThreadPool* pool, AsyncJob* job = nullptr) {
+    return parallelReduce(pool, 0, size, Grain::automatic(VERIFY_BLOCK), MultisetDigest(),
+                          [data](qint64 start, qint64 end) {
+        return multisetDigest(data + start, data + end);
+    }, [](MultisetDigest a, const MultisetDigest& b) { return a += b; }, job, "Multiset digest");
+}
+
+// True if pred(data[i]) holds for every element.
+template <typename T, typename Predicate>
+bool parallelAllOf(const T* data, qint64 size, QThreadPool* pool, Predicate pred, AsyncJob* job = nullptr) {
+    QAtomicInt failed(0);
+    parallelFor(pool, 0, size, Grain::automatic(VERIFY_BLOCK), [data, &pred, &failed](qint64 start, qint64 stop) {
+        for (qint64 block = start; block < stop && failed.load() == 0; block += VERIFY_BLOCK) {
+            qint64 end = std::min(block + VERIFY_BLOCK, stop);
+            for (qint64 j = block; j < end; ++j) {
+                if (!pred(data[j])) {
+                    failed.storeRelease(1);
+                    return;
+                }
+            }
+        }
+    }, job, "All-of check");
+    return failed.load() == 0;
+}
+
+// True if data is ordered by comp. Each block also checks the pair that
+// joins it to the previous one.
+template <typename T, typename Compare = std::less<T>>
+bool parallelIsSorted(const T* data, qint64 size, QThreadPool* pool, Compare comp = Compare(), AsyncJob* job = nullptr) {
+    QAtomicInt failed(0);
+    parallelFor(pool, 0, size, Grain::automatic(VERIFY_BLOCK), [data, &comp, &failed](qint64 start, qint64 stop) {
+        for (qint64 block = std::max<qint64>(1, start); block < stop && failed.load() == 0; block += VERIFY_BLOCK) {
+            qint64 end = std::min(block + VERIFY_BLOCK, stop);
+            for (qint64 j = block; j < end; ++j) {
+                if (comp(data[j], data[j - 1])) {
+                    failed.storeRelease(1);
+                    return;
+                }
+            }
+        }
+    }, job, "Sortedness check");
+    return failed.load() == 0;
+}
+
+// Both checks for data that is seen a slice at a time, e.g. by
+// ParallelSorter::pipelinedSort(): each producer or merge worker folds in its
+// own slice right after writing it, while it is still cached, instead of a
+// separate pass re-reading the whole output. Slices are checked on their
+// own; the pairs that straddle two output slices are checked by isSorted()
+// from the ends each slice left behind. Safe to call from any thread.
+template <typename T, typename Compare = std::less<T>>
+class SliceSortCheck
+{
+public:
+    explicit SliceSortCheck(Compare comp = Compare()) : m_comp(comp), m_slicesOrdered(true) {}
+
+    // Input elements, in any order and any slicing.
+    void addInput(const T* begin, const T* end) {
+        MultisetDigest d = multisetDigest(begin, end);
+        QMutexLocker locker(&m_mutex);
+        m_input += d;
+    }
+
+    // Output elements [firstIndex, firstIndex + (end - begin)); slices may
+    // arrive in any order but must not overlap.
+    void addOutput(const T* begin, const T* end, qint64 firstIndex) {
+        if (begin == end) return;
+        bool ordered = std::is_sorted(begin, end, m_comp);
+        MultisetDigest d = multisetDigest(begin, end);
+        QMutexLocker locker(&m_mutex);
+        m_output += d;
+        m_slicesOrdered = m_slicesOrdered && ordered;
+        m_slices.push_back(OutputSlice{firstIndex, end - begin, *begin, *(end - 1)});
+    }
+
+    // True if the output slices are ordered and, laid end to end from index
+    // 0, cover exactly [0, size) with no gap and no descent at their seams.
+    // Missing slices, e.g. of a cancelled run, make it false.
+    bool isSorted(qint64 size) const {
+        QMutexLocker locker(&m_mutex);
+        if (!m_slicesOrdered) return false;
+        std::vector<OutputSlice> slices = m_slices;
+        std::sort(slices.begin(), slices.end(), [](const OutputSlice& a, const OutputSlice& b) {
+            return a.firstIndex < b.firstIndex;
+        });
+        qint64 next = 0;
+        for (size_t i = 0; i < slices.size(); ++i) {
+            if (slices[i].firstIndex != next) return false;
+            if (i > 0 && m_comp(slices[i].front, slices[i - 1].back)) return false;
+            next += slices[i].count;
+        }
+        return next == size;
+    }
+
+    // True if the output is a permutation of the input.
+    bool isPermutation() const {
+        QMutexLocker locker(&m_mutex);
+        return m_output == m_input;
+    }
+
+    MultisetDigest inputDigest() const {
+        QMutexLocker locker(&m_mutex);
+        return m_input;
+    }
+
+private:
+    struct OutputSlice {
+        qint64 firstIndex;
+        qint64 count;
+        T front;
+        T back;
+    };
+
+    Compare m_comp;
+    mutable QMutex m_mutex; // Held once per slice, never while hashing or comparing
+    MultisetDigest m_input;
+    MultisetDigest m_output;
+    bool m_slicesOrdered;
+    std::vector<OutputSlice> m_slices;
+
+    Q_DISABLE_COPY(SliceSortCheck)
+};
+
+#endif // PARALLELVERIFY_H
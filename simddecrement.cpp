@@ -0,0 +1,206 @@
+#include "simddecrement.h"
+#include "simdsort.h"
+#include <algorithm>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+// Per-function targets, as in simdsort.cpp
+#define SIMDDECREMENT_X86
+#define TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#define TARGET_SSE41 __attribute__((target("sse4.1,popcnt")))
+#define COUNT_BITS(x) __builtin_popcount(x)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SIMDDECREMENT_X86
+#define TARGET_AVX2
+#define TARGET_SSE41
+#include <intrin.h>
+#define COUNT_BITS(x) __popcnt(x)
+#endif
+
+#ifdef SIMDDECREMENT_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Elements [first, end) all lie in the 64-element group that uses 'word'.
+template <typename T>
+qint64 decrementScalar(T* values, qint64 first, qint64 end, quint64 word) {
+    qint64 positive = 0;
+    for (qint64 i = first; i < end; ++i) {
+        T v = values[i];
+        v = (T)(v - (T)(((word >> (i % 64)) & 1) & (quint64)(v > 0)));
+        values[i] = v;
+        positive += v > 0;
+    }
+    return positive;
+}
+
+template <typename T>
+qint64 decrementGroupScalar(T* group, quint64 word) {
+    return decrementScalar(group, 0, 64, word);
+}
+
+// One 64-element group per call, specialized per element width: the wider
+// the element, the fewer lanes per register and coin bits per register.
+// Signed ints may be negative and use (v > 0); the unsigned widths only
+// hold values >= 0 and use (v != 0), which has a compare at every width.
+template <typename T>
+struct DecrementGroup;
+
+#ifdef SIMDDECREMENT_X86
+
+template <>
+struct DecrementGroup<int> {
+    TARGET_AVX2 static qint64 avx2(int* group, quint64 word) {
+        const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        const __m256i zero = _mm256_setzero_si256();
+        qint64 positive = 0;
+        for (int k = 0; k < 8; ++k) {
+            __m256i coins = _mm256_and_si256(_mm256_set1_epi32((int)((word >> (8 * k)) & 0xFF)), laneBits);
+            __m256i heads = _mm256_cmpeq_epi32(coins, laneBits);
+            __m256i* p = reinterpret_cast<__m256i*>(group + 8 * k);
+            __m256i v = _mm256_loadu_si256(p);
+            v = _mm256_add_epi32(v, _mm256_and_si256(heads, _mm256_cmpgt_epi32(v, zero))); // -1 where heads and > 0
+            _mm256_storeu_si256(p, v);
+            positive += COUNT_BITS((unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, zero))));
+        }
+        return positive;
+    }
+
+    TARGET_SSE41 static qint64 sse41(int* group, quint64 word) {
+        const __m128i laneBits = _mm_setr_epi32(1, 2, 4, 8);
+        const __m128i zero = _mm_setzero_si128();
+        qint64 positive = 0;
+        for (int k = 0; k < 16; ++k) {
+            __m128i coins = _mm_and_si128(_mm_set1_epi32((int)((word >> (4 * k)) & 0xF)), laneBits);
+            __m128i heads = _mm_cmpeq_epi32(coins, laneBits);
+            __m128i* p = reinterpret_cast<__m128i*>(group + 4 * k);
+            __m128i v = _mm_loadu_si128(p);
+            v = _mm_add_epi32(v, _mm_and_si128(heads, _mm_cmpgt_epi32(v, zero)));
+            _mm_storeu_si128(p, v);
+            positive += COUNT_BITS((unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, zero))));
+        }
+        return positive;
+    }
+};
+
+template <>
+struct DecrementGroup<quint16> {
+    TARGET_AVX2 static qint64 avx2(quint16* group, quint64 word) {
+        const __m256i laneBits = _mm256_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192,
+                                                   16384, (short)0x8000);
+        const __m256i zero = _mm256_setzero_si256();
+        qint64 positive = 0;
+        for (int k = 0; k < 4; ++k) {
+            __m256i coins = _mm256_and_si256(_mm256_set1_epi16((short)(word >> (16 * k))), laneBits);
+            __m256i heads = _mm256_cmpeq_epi16(coins, laneBits);
+            __m256i* p = reinterpret_cast<__m256i*>(group + 16 * k);
+            __m256i v = _mm256_loadu_si256(p);
+            v = _mm256_add_epi16(v, _mm256_andnot_si256(_mm256_cmpeq_epi16(v, zero), heads));
+            _mm256_storeu_si256(p, v);
+            // Two mask bits per 16-bit lane
+            positive += COUNT_BITS(~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi16(v, zero))) / 2;
+        }
+        return positive;
+    }
+
+    TARGET_SSE41 static qint64 sse41(quint16* group, quint64 word) {
+        const __m128i laneBits = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+        const __m128i zero = _mm_setzero_si128();
+        qint64 positive = 0;
+        for (int k = 0; k < 8; ++k) {
+            __m128i coins = _mm_and_si128(_mm_set1_epi16((short)((word >> (8 * k)) & 0xFF)), laneBits);
+            __m128i heads = _mm_cmpeq_epi16(coins, laneBits);
+            __m128i* p = reinterpret_cast<__m128i*>(group + 8 * k);
+            __m128i v = _mm_loadu_si128(p);
+            v = _mm_add_epi16(v, _mm_andnot_si128(_mm_cmpeq_epi16(v, zero), heads));
+            _mm_storeu_si128(p, v);
+            positive += COUNT_BITS(~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi16(v, zero)) & 0xFFFF) / 2;
+        }
+        return positive;
+    }
+};
+
+template <>
+struct DecrementGroup<quint8> {
+    // Byte k of the coin bits is copied into lanes 8k .. 8k + 7 by a byte
+    // shuffle, then each lane keeps its own bit.
+    TARGET_AVX2 static qint64 avx2(quint8* group, quint64 word) {
+        const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                                2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+        const __m256i laneBits = _mm256_set1_epi64x((qint64)0x8040201008040201ull);
+        const __m256i zero = _mm256_setzero_si256();
+        qint64 positive = 0;
+        for (int k = 0; k < 2; ++k) {
+            __m256i bits = _mm256_shuffle_epi8(_mm256_set1_epi32((int)(word >> (32 * k))), spread);
+            __m256i heads = _mm256_cmpeq_epi8(_mm256_and_si256(bits, laneBits), laneBits);
+            __m256i* p = reinterpret_cast<__m256i*>(group + 32 * k);
+            __m256i v = _mm256_loadu_si256(p);
+            v = _mm256_add_epi8(v, _mm256_andnot_si256(_mm256_cmpeq_epi8(v, zero), heads));
+            _mm256_storeu_si256(p, v);
+            positive += COUNT_BITS(~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero)));
+        }
+        return positive;
+    }
+
+    TARGET_SSE41 static qint64 sse41(quint8* group, quint64 word) {
+        const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+        const __m128i laneBits = _mm_set1_epi64x((qint64)0x8040201008040201ull);
+        const __m128i zero = _mm_setzero_si128();
+        qint64 positive = 0;
+        for (int k = 0; k < 4; ++k) {
+            __m128i bits = _mm_shuffle_epi8(_mm_set1_epi16((short)(word >> (16 * k))), spread);
+            __m128i heads = _mm_cmpeq_epi8(_mm_and_si128(bits, laneBits), laneBits);
+            __m128i* p = reinterpret_cast<__m128i*>(group + 16 * k);
+            __m128i v = _mm_loadu_si128(p);
+            v = _mm_add_epi8(v, _mm_andnot_si128(_mm_cmpeq_epi8(v, zero), heads));
+            _mm_storeu_si128(p, v);
+            positive += COUNT_BITS(~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) & 0xFFFF);
+        }
+        return positive;
+    }
+};
+
+#endif // SIMDDECREMENT_X86
+
+template <typename T>
+qint64 decrementPass(T* values, qint64 firstIndex, qint64 endIndex, const CounterRng& coins, quint64 firstWord) {
+    qint64 (*decrementGroup)(T*, quint64) = decrementGroupScalar<T>;
+#ifdef SIMDDECREMENT_X86
+    switch (simdLevel()) {
+    case SimdAvx2: decrementGroup = DecrementGroup<T>::avx2; break;
+    case SimdSse41: decrementGroup = DecrementGroup<T>::sse41; break;
+    default: break;
+    }
+#endif
+
+    // Partial groups at either end go through the scalar loop.
+    qint64 positive = 0;
+    qint64 i = firstIndex;
+    while (i < endIndex) {
+        qint64 group = i / 64;
+        qint64 groupEnd = std::min((group + 1) * 64, endIndex);
+        quint64 word = coins.at(firstWord + (quint64)group);
+        if (i % 64 == 0 && groupEnd - i == 64) {
+            positive += decrementGroup(values + i, word);
+        } else {
+            positive += decrementScalar(values, i, groupEnd, word);
+        }
+        i = groupEnd;
+    }
+    return positive;
+}
+
+} // namespace
+
+qint64 simdDecrementPass(quint8* values, qint64 firstIndex, qint64 endIndex, const CounterRng& coins, quint64 firstWord) {
+    return decrementPass(values, firstIndex, endIndex, coins, firstWord);
+}
+
+qint64 simdDecrementPass(quint16* values, qint64 firstIndex, qint64 endIndex, const CounterRng& coins, quint64 firstWord) {
+    return decrementPass(values, firstIndex, endIndex, coins, firstWord);
+}
+
+qint64 simdDecrementPass(int* values, qint64 firstIndex, qint64 endIndex, const CounterRng& coins, quint64 firstWord) {
+    return decrementPass(values, firstIndex, endIndex, coins, firstWord);
+}
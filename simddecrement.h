@@ -0,0 +1,38 @@
+#ifndef SIMDDECREMENT_H
+#define SIMDDECREMENT_H
+
+#include "counterrng.h"
+#include <QtGlobal>
+
+// Task 3's decrement pass as a streaming kernel: every positive value is
+// decremented with probability 1/2, and the values still positive are
+// counted.
+//
+// Coin flips come 64 to a word from a CounterRng: element i uses bit i % 64
+// of coins.at(firstWord + i / 64). The flips for a pass are therefore fixed
+// by the seed and the pass, whatever the chunking or thread count.
+//
+// Per register, the matching coin bits are spread into a lane mask, ANDed
+// with (value > 0) and added as -1, so there is no branch per element. The
+// count comes from a compare, a movemask and a popcount. Each element width
+// has its own kernel: a 256-bit register holds 8 ints, 16 quint16s or 32
+// quint8s, so narrow storage moves proportionally fewer bytes per pass. The
+// instruction set is the one simdLevel() picked (see simdsort.h).
+
+// Runs the pass over values[firstIndex, endIndex); returns how many are still > 0.
+qint64 simdDecrementPass(quint8* values, qint64 firstIndex, qint64 endIndex, const CounterRng& coins, quint64 firstWord);
+qint64 simdDecrementPass(quint16* values, qint64 firstIndex, qint64 endIndex, const CounterRng& coins, quint64 firstWord);
+qint64 simdDecrementPass(int* values, qint64 firstIndex, qint64 endIndex, const CounterRng& coins, quint64 firstWord);
+
+// Coin for element 'index', as used by simdDecrementPass(). For sparse passes
+// that visit a list of indices; 'word' and 'wordIndex' cache the last draw,
+// with wordIndex initialised to -1.
+inline bool decrementCoin(const CounterRng& coins, quint64 firstWord, qint64 index, quint64* word, qint64* wordIndex) {
+    if (index / 64 != *wordIndex) {
+        *wordIndex = index / 64;
+        *word = coins.at(firstWord + (quint64)*wordIndex);
+    }
+    return (*word >> (index % 64)) & 1;
+}
+
+#endif // SIMDDECREMENT_H
@@ -0,0 +1,312 @@
+#include "simdsort.h"
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+// Per-function targets, so the rest of the build needs no -mavx2 and still runs everywhere
+#define SIMDSORT_X86
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SIMDSORT_X86
+#define TARGET_AVX2
+#define TARGET_SSE41
+#include <intrin.h>
+#endif
+
+#ifdef SIMDSORT_X86
+#include <immintrin.h>
+#endif
+
+typedef int* (*MergeFunction)(const int* a, const int* aEnd, const int* b, const int* bEnd, int* out);
+
+static int* scalarMerge(const int* a, const int* aEnd, const int* b, const int* bEnd, int* out) {
+    return std::merge(a, aEnd, b, bEnd, out);
+}
+
+// Bottom-up merge passes over runs of 'width' values, ping-ponging between
+// 'data' and 'buffer'; the result always ends up in 'data'.
+static void mergePasses(int* data, qint64 size, int* buffer, qint64 width, MergeFunction merge) {
+    int* source = data;
+    int* target = buffer;
+    for (; width < size; width *= 2) {
+        for (qint64 start = 0; start < size; start += 2 * width) {
+            qint64 mid = std::min(start + width, size);
+            qint64 end = std::min(start + 2 * width, size);
+            merge(source + start, source + mid, source + mid, source + end, target + start);
+        }
+        std::swap(source, target);
+    }
+    if (source != data) {
+        std::memcpy(data, source, size * sizeof(int));
+    }
+}
+
+// Emits what a vector merge left over: the 'carry' register (sorted, and
+// not smaller than anything emitted) plus the tails of both inputs, at least
+// one of which is shorter than a register.
+static int* finishMerge(const int* carry, int carrySize, const int* a, const int* aEnd,
+                        const int* b, const int* bEnd, int* out) {
+    int head[16];
+    bool aIsShort = (aEnd - a) < (bEnd - b);
+    const int* shortBegin = aIsShort ? a : b;
+    const int* shortEnd = aIsShort ? aEnd : bEnd;
+    int* headEnd = std::merge(carry, carry + carrySize, shortBegin, shortEnd, head);
+    return aIsShort ? std::merge(head, headEnd, b, bEnd, out) : std::merge(head, headEnd, a, aEnd, out);
+}
+
+#ifdef SIMDSORT_X86
+
+// === AVX2: 8 lanes ===
+
+TARGET_AVX2 static inline void minMax8(__m256i& a, __m256i& b) {
+    __m256i lo = _mm256_min_epi32(a, b);
+    b = _mm256_max_epi32(a, b);
+    a = lo;
+}
+
+// Sorts a bitonic register: compare-exchange at distance 4, 2, then 1.
+TARGET_AVX2 static inline __m256i bitonicClean8(__m256i v) {
+    __m256i p = _mm256_permute2x128_si256(v, v, 1);
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xF0);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v = _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xCC);
+    p = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm256_blend_epi32(_mm256_min_epi32(v, p), _mm256_max_epi32(v, p), 0xAA);
+}
+
+// Two sorted registers in; the 8 smallest values (sorted) in 'lo', the 8 largest in 'hi'.
+TARGET_AVX2 static inline void merge8(__m256i& lo, __m256i& hi) {
+    __m256i reversed = _mm256_permutevar8x32_epi32(hi, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    __m256i mins = _mm256_min_epi32(lo, reversed);
+    __m256i maxs = _mm256_max_epi32(lo, reversed);
+    lo = bitonicClean8(mins);
+    hi = bitonicClean8(maxs);
+}
+
+// Sorts 64 values into eight sorted runs of 8: an optimal 19-comparator
+// network sorts each column across the registers, and a transpose turns
+// columns into rows.
+TARGET_AVX2 static void sortBlock64(int* block) {
+    __m256i r[8];
+    for (int i = 0; i < 8; ++i) r[i] = _mm256_loadu_si256((const __m256i*)(block + 8 * i));
+
+    minMax8(r[0], r[2]); minMax8(r[1], r[3]); minMax8(r[4], r[6]); minMax8(r[5], r[7]);
+    minMax8(r[0], r[4]); minMax8(r[1], r[5]); minMax8(r[2], r[6]); minMax8(r[3], r[7]);
+    minMax8(r[0], r[1]); minMax8(r[2], r[3]); minMax8(r[4], r[5]); minMax8(r[6], r[7]);
+    minMax8(r[2], r[4]); minMax8(r[3], r[5]);
+    minMax8(r[1], r[4]); minMax8(r[3], r[6]);
+    minMax8(r[1], r[2]); minMax8(r[3], r[4]); minMax8(r[5], r[6]);
+
+    __m256i t[8];
+    for (int i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    __m256i s[8];
+    for (int i = 0; i < 8; i += 4) {
+        s[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        s[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        s[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        s[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (int i = 0; i < 4; ++i) {
+        _mm256_storeu_si256((__m256i*)(block + 8 * i), _mm256_permute2x128_si256(s[i], s[i + 4], 0x20));
+        _mm256_storeu_si256((__m256i*)(block + 8 * (i + 4)), _mm256_permute2x128_si256(s[i], s[i + 4], 0x31));
+    }
+}
+
+TARGET_AVX2 static int* mergeAvx2(const int* a, const int* aEnd, const int* b, const int* bEnd, int* out) {
+    if (aEnd - a < 8 || bEnd - b < 8) {
+        return std::merge(a, aEnd, b, bEnd, out);
+    }
+    __m256i lo = _mm256_loadu_si256((const __m256i*)a);
+    __m256i hi = _mm256_loadu_si256((const __m256i*)b);
+    a += 8;
+    b += 8;
+    merge8(lo, hi);
+    _mm256_storeu_si256((__m256i*)out, lo);
+    out += 8;
+
+    while (aEnd - a >= 8 && bEnd - b >= 8) {
+        // Branch-free choice of the input with the smaller head
+        bool takeA = *a < *b;
+        const int* next = takeA ? a : b;
+        a += takeA ? 8 : 0;
+        b += takeA ? 0 : 8;
+        lo = _mm256_loadu_si256((const __m256i*)next);
+        merge8(lo, hi);
+        _mm256_storeu_si256((__m256i*)out, lo);
+        out += 8;
+    }
+
+    int carry[8];
+    _mm256_storeu_si256((__m256i*)carry, hi);
+    return finishMerge(carry, 8, a, aEnd, b, bEnd, out);
+}
+
+TARGET_AVX2 static void sortAvx2(int* data, qint64 size, int* buffer) {
+    qint64 blocked = size - size % 64;
+    for (qint64 i = 0; i < blocked; i += 64) {
+        sortBlock64(data + i);
+    }
+    std::sort(data + blocked, data + size); // Sorted as a whole, so also as runs of 8
+    mergePasses(data, size, buffer, 8, mergeAvx2);
+}
+
+// === SSE4.1: 4 lanes ===
+
+TARGET_SSE41 static inline void minMax4(__m128i& a, __m128i& b) {
+    __m128i lo = _mm_min_epi32(a, b);
+    b = _mm_max_epi32(a, b);
+    a = lo;
+}
+
+TARGET_SSE41 static inline __m128i bitonicClean4(__m128i v) {
+    __m128i p = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    v = _mm_blend_epi16(_mm_min_epi32(v, p), _mm_max_epi32(v, p), 0xF0);
+    p = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_blend_epi16(_mm_min_epi32(v, p), _mm_max_epi32(v, p), 0xCC);
+}
+
+TARGET_SSE41 static inline void merge4(__m128i& lo, __m128i& hi) {
+    __m128i reversed = _mm_shuffle_epi32(hi, _MM_SHUFFLE(0, 1, 2, 3));
+    __m128i mins = _mm_min_epi32(lo, reversed);
+    __m128i maxs = _mm_max_epi32(lo, reversed);
+    lo = bitonicClean4(mins);
+    hi = bitonicClean4(maxs);
+}
+
+TARGET_SSE41 static void sortBlock16(int* block) {
+    __m128i r[4];
+    for (int i = 0; i < 4; ++i) r[i] = _mm_loadu_si128((const __m128i*)(block + 4 * i));
+
+    minMax4(r[0], r[1]); minMax4(r[2], r[3]);
+    minMax4(r[0], r[2]); minMax4(r[1], r[3]);
+    minMax4(r[1], r[2]);
+
+    __m128i t0 = _mm_unpacklo_epi32(r[0], r[1]);
+    __m128i t1 = _mm_unpacklo_epi32(r[2], r[3]);
+    __m128i t2 = _mm_unpackhi_epi32(r[0], r[1]);
+    __m128i t3 = _mm_unpackhi_epi32(r[2], r[3]);
+    _mm_storeu_si128((__m128i*)(block + 0), _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128((__m128i*)(block + 4), _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128((__m128i*)(block + 8), _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128((__m128i*)(block + 12), _mm_unpackhi_epi64(t2, t3));
+}
+
+TARGET_SSE41 static int* mergeSse41(const int* a, const int* aEnd, const int* b, const int* bEnd, int* out) {
+    if (aEnd - a < 4 || bEnd - b < 4) {
+        return std::merge(a, aEnd, b, bEnd, out);
+    }
+    __m128i lo = _mm_loadu_si128((const __m128i*)a);
+    __m128i hi = _mm_loadu_si128((const __m128i*)b);
+    a += 4;
+    b += 4;
+    merge4(lo, hi);
+    _mm_storeu_si128((__m128i*)out, lo);
+    out += 4;
+
+    while (aEnd - a >= 4 && bEnd - b >= 4) {
+        bool takeA = *a < *b;
+        const int* next = takeA ? a : b;
+        a += takeA ? 4 : 0;
+        b += takeA ? 0 : 4;
+        lo = _mm_loadu_si128((const __m128i*)next);
+        merge4(lo, hi);
+        _mm_storeu_si128((__m128i*)out, lo);
+        out += 4;
+    }
+
+    int carry[4];
+    _mm_storeu_si128((__m128i*)carry, hi);
+    return finishMerge(carry, 4, a, aEnd, b, bEnd, out);
+}
+
+TARGET_SSE41 static void sortSse41(int* data, qint64 size, int* buffer) {
+    qint64 blocked = size - size % 16;
+    for (qint64 i = 0; i < blocked; i += 16) {
+        sortBlock16(data + i);
+    }
+    std::sort(data + blocked, data + size);
+    mergePasses(data, size, buffer, 4, mergeSse41);
+}
+
+static SimdLevel detectSimdLevel() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse41 = (info[2] >> 19) & 1;
+    // AVX state must also be enabled by the OS (OSXSAVE + XCR0)
+    bool osAvx = ((info[2] >> 27) & 1) && ((info[2] >> 28) & 1) && (_xgetbv(0) & 6) == 6;
+    if (osAvx && maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        if ((info[1] >> 5) & 1) return SimdAvx2;
+    }
+    if (sse41) return SimdSse41;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdAvx2;
+    if (__builtin_cpu_supports("sse4.1")) return SimdSse41;
+#endif
+    return SimdScalar;
+}
+
+#else
+
+static SimdLevel detectSimdLevel() {
+    return SimdScalar;
+}
+
+#endif // SIMDSORT_X86
+
+SimdLevel simdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdAvx2: return "AVX2";
+    case SimdSse41: return "SSE4.1";
+    default: return "scalar";
+    }
+}
+
+void simdSortInts(int* data, qint64 size, int* buffer) {
+    // Below a few blocks the merge passes cost more than std::sort's insertion sort
+    if (size < 128) {
+        std::sort(data, data + size);
+        return;
+    }
+#ifdef SIMDSORT_X86
+    switch (simdLevel()) {
+    case SimdAvx2:
+        sortAvx2(data, size, buffer);
+        return;
+    case SimdSse41:
+        sortSse41(data, size, buffer);
+        return;
+    default:
+        break;
+    }
+#endif
+    (void)buffer;
+    std::sort(data, data + size);
+}
+
+int* simdMergeInts(const int* a, const int* aEnd, const int* b, const int* bEnd, int* out) {
+#ifdef SIMDSORT_X86
+    switch (simdLevel()) {
+    case SimdAvx2:
+        return mergeAvx2(a, aEnd, b, bEnd, out);
+    case SimdSse41:
+        return mergeSse41(a, aEnd, b, bEnd, out);
+    default:
+        break;
+    }
+#endif
+    return scalarMerge(a, aEnd, b, bEnd, out);
+}
@@ -0,0 +1,38 @@
+#ifndef SIMDSORT_H
+#define SIMDSORT_H
+
+#include <QtGlobal>
+
+// Branch-free sorting kernels for 32-bit ints, used by ParallelSorter as the
+// chunk sort and two-way merge primitive for int data in natural order.
+//
+// Sorting: blocks of 64 (AVX2) or 16 (SSE4.1) values are sorted by a
+// min/max sorting network across registers plus a transpose, giving sorted
+// runs of one register each. Runs are then merged pairwise with the merge
+// below, ping-ponging through a caller-provided buffer.
+//
+// Merging: a bitonic merge network over two registers. Each step emits the
+// lower half and keeps the upper half; the next register is taken from
+// whichever input has the smaller head, selected with a conditional move
+// rather than a branch.
+//
+// The instruction set is picked at runtime, once, from what the CPU
+// supports; other CPUs and compilers use std::sort / std::merge.
+
+enum SimdLevel {
+    SimdScalar,
+    SimdSse41,
+    SimdAvx2
+};
+
+SimdLevel simdLevel();
+const char* simdLevelName(SimdLevel level);
+
+// Sorts [data, data + size) ascending. 'buffer' must hold 'size' ints and is clobbered.
+void simdSortInts(int* data, qint64 size, int* buffer);
+
+// Merges the sorted ranges [a, aEnd) and [b, bEnd) into 'out' (which must not
+// overlap them) and returns the end of the output.
+int* simdMergeInts(const int* a, const int* aEnd, const int* b, const int* bEnd, int* out);
+
+#endif // SIMDSORT_H
@@ -0,0 +1,90 @@
+#include "stringmatrix.h"
+#include "simdsort.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+// Big-endian value of a string of width <= sizeof(Key) bytes. All strings in
+// a matrix have the same width, so key order is string order.
+template <typename Key>
+Key loadKey(const char* text, int width) {
+    Key key = 0;
+    for (int i = 0; i < width; ++i) {
+        key = (Key)((key << 8) | (uchar)text[i]);
+    }
+    return key;
+}
+
+template <typename Key>
+void storeKey(char* text, int width, Key key) {
+    for (int i = width - 1; i >= 0; --i) {
+        text[i] = (char)(key & 0xFF);
+        key >>= 8;
+    }
+}
+
+} // namespace
+
+void PackedStringMatrix::reset(int rows, int cols, int width) {
+    m_rows = rows;
+    m_cols = cols;
+    m_width = width;
+    m_bytes.resize((size_t)rows * cols * width);
+}
+
+void PackedStringMatrix::sortRows(int firstRow, int endRow) {
+    if (m_width == 0 || m_cols < 2) return;
+
+    // Scratch reused across the rows of this call
+    if (m_width <= 4) {
+        // Keys fit in 31 bits only for width < 4, so flip the top bit to map
+        // unsigned order onto the signed order simdSortInts() sorts by.
+        std::vector<int> keys(m_cols);
+        std::vector<int> buffer(m_cols);
+        for (int r = firstRow; r < endRow; ++r) {
+            for (int j = 0; j < m_cols; ++j) {
+                keys[j] = (int)(loadKey<quint32>(cell(r, j), m_width) ^ 0x80000000u);
+            }
+            simdSortInts(keys.data(), m_cols, buffer.data());
+            for (int j = 0; j < m_cols; ++j) {
+                storeKey<quint32>(cell(r, j), m_width, (quint32)keys[j] ^ 0x80000000u);
+            }
+        }
+    } else if (m_width <= 8) {
+        std::vector<quint64> keys(m_cols);
+        for (int r = firstRow; r < endRow; ++r) {
+            for (int j = 0; j < m_cols; ++j) {
+                keys[j] = loadKey<quint64>(cell(r, j), m_width);
+            }
+            std::sort(keys.begin(), keys.end());
+            for (int j = 0; j < m_cols; ++j) {
+                storeKey<quint64>(cell(r, j), m_width, keys[j]);
+            }
+        }
+    } else {
+        // Wider strings: sort cell indices by memcmp, then permute.
+        std::vector<int> order(m_cols);
+        std::vector<char> sorted((size_t)m_cols * m_width);
+        for (int r = firstRow; r < endRow; ++r) {
+            const char* row = cell(r, 0);
+            const int width = m_width;
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [row, width](int a, int b) {
+                return std::memcmp(row + (qint64)a * width, row + (qint64)b * width, width) < 0;
+            });
+            for (int j = 0; j < m_cols; ++j) {
+                std::memcpy(sorted.data() + (qint64)j * width, row + (qint64)order[j] * width, width);
+            }
+            std::memcpy(cell(r, 0), sorted.data(), sorted.size());
+        }
+    }
+}
+
+bool PackedStringMatrix::isRowSorted(int row) const {
+    for (int j = 1; j < m_cols; ++j) {
+        if (std::memcmp(cell(row, j - 1), cell(row, j), m_width) > 0) return false;
+    }
+    return true;
+}
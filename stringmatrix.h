@@ -0,0 +1,47 @@
+#ifndef STRINGMATRIX_H
+#define STRINGMATRIX_H
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+// Task 2's matrix as one row-major buffer of fixed-width Latin-1 strings,
+// instead of one heap-allocated UTF-16 QString per cell: 4 bytes per cell
+// for 4-char strings, no pointers to chase and no reference counts touched
+// while sorting.
+//
+// Strings of up to 8 bytes sort as integer keys: the bytes read big-endian
+// compare exactly like the strings, so a row sorts as plain uint32/uint64
+// values (the 32-bit case through simdSortInts()). QStrings are only built
+// for display, by at().
+class PackedStringMatrix
+{
+public:
+    PackedStringMatrix() : m_rows(0), m_cols(0), m_width(0) {}
+
+    // Resizes to rows x cols strings of 'width' bytes; the contents are unspecified.
+    void reset(int rows, int cols, int width);
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    int width() const { return m_width; }
+    qint64 byteSize() const { return (qint64)m_bytes.size(); }
+    bool isEmpty() const { return m_bytes.empty(); }
+
+    char* cell(int row, int col) { return m_bytes.data() + ((qint64)row * m_cols + col) * m_width; }
+    const char* cell(int row, int col) const { return m_bytes.data() + ((qint64)row * m_cols + col) * m_width; }
+    QString at(int row, int col) const { return QString::fromLatin1(cell(row, col), m_width); }
+
+    // Sorts rows [firstRow, endRow) in place. Disjoint row ranges may be
+    // sorted concurrently.
+    void sortRows(int firstRow, int endRow);
+    bool isRowSorted(int row) const;
+
+private:
+    int m_rows;
+    int m_cols;
+    int m_width;
+    std::vector<char> m_bytes;
+};
+
+#endif // STRINGMATRIX_H
@@ -0,0 +1,343 @@
+#include "stringsort.h"
+#include "asyncjob.h"
+#include "parallelsort.h"
+#include "taskgraph.h"
+#include <QThreadPool>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// A string plus its cached key at the current depth.
+struct CachedString {
+    quint64 key;
+    const ushort* chars;
+    int length;
+    qint64 index; // Position in the input, for the final permutation
+};
+
+// Three code units per key, each stored as unit + 1 in 17 bits, with 0 for
+// positions past the end. A key compares like the three units it covers,
+// and a zero low field means the string ends inside the key.
+const int KEY_CHARS = 3;
+const int KEY_BITS = 17;
+const quint64 KEY_FIELD_MASK = (1ull << KEY_BITS) - 1;
+
+const qint64 INSERTION_SORT_THRESHOLD = 24;
+
+inline quint64 cacheKey(const ushort* chars, int length, int depth) {
+    quint64 key = 0;
+    for (int i = 0; i < KEY_CHARS; ++i) {
+        int pos = depth + i;
+        key = (key << KEY_BITS) | (pos < length ? (quint64)chars[pos] + 1 : 0);
+    }
+    return key;
+}
+
+inline bool keyEndsString(quint64 key) {
+    return (key & KEY_FIELD_MASK) == 0;
+}
+
+// Length of the common prefix of a and b, given that it is at least 'from'.
+inline int commonPrefix(const CachedString& a, const CachedString& b, int from) {
+    int limit = std::min(a.length, b.length);
+    int pos = from;
+    while (pos < limit && a.chars[pos] == b.chars[pos]) ++pos;
+    return pos;
+}
+
+// True if a sorts before b; both share 'prefix' characters.
+inline bool lessAfterPrefix(const CachedString& a, const CachedString& b, int prefix) {
+    if (prefix == b.length) return false;
+    if (prefix == a.length) return true;
+    return a.chars[prefix] < b.chars[prefix];
+}
+
+// Full comparison, for co-ranking merge pieces.
+struct CachedStringLess {
+    bool operator()(const CachedString& a, const CachedString& b) const {
+        return lessAfterPrefix(a, b, commonPrefix(a, b, 0));
+    }
+};
+
+// Insertion sort of a group whose keys were cached at 'depth'.
+void insertionSort(CachedString* a, qint64 n, int depth) {
+    for (qint64 i = 1; i < n; ++i) {
+        CachedString item = a[i];
+        qint64 j = i;
+        while (j > 0) {
+            const CachedString& prev = a[j - 1];
+            bool less;
+            if (item.key != prev.key) {
+                less = item.key < prev.key;
+            } else if (keyEndsString(item.key)) {
+                less = false; // Equal strings
+            } else {
+                int prefix = commonPrefix(item, prev, depth + KEY_CHARS);
+                less = lessAfterPrefix(item, prev, prefix);
+            }
+            if (!less) break;
+            a[j] = prev;
+            --j;
+        }
+        a[j] = item;
+    }
+}
+
+inline quint64 medianOfThree(quint64 a, quint64 b, quint64 c) {
+    if (a < b) return b < c ? b : (a < c ? c : a);
+    return a < c ? a : (b < c ? c : b);
+}
+
+// Keys of a[0, n) must be cached at 'depth'.
+void multikeyQuicksort(CachedString* a, qint64 n, int depth) {
+    while (n > INSERTION_SORT_THRESHOLD) {
+        quint64 pivot = medianOfThree(a[0].key, a[n / 2].key, a[n - 1].key);
+
+        // Three-way partition: [0, lt) < pivot, [lt, gt) == pivot, [gt, n) > pivot
+        qint64 lt = 0;
+        qint64 i = 0;
+        qint64 gt = n;
+        while (i < gt) {
+            if (a[i].key < pivot) {
+                std::swap(a[lt++], a[i++]);
+            } else if (a[i].key > pivot) {
+                std::swap(a[i], a[--gt]);
+            } else {
+                ++i;
+            }
+        }
+        multikeyQuicksort(a, lt, depth);
+        multikeyQuicksort(a + gt, n - gt, depth);
+
+        // The equal group continues at the next characters, unless those
+        // strings have all ended.
+        if (keyEndsString(pivot)) return;
+        a += lt;
+        n = gt - lt;
+        depth += KEY_CHARS;
+        for (qint64 k = 0; k < n; ++k) {
+            a[k].key = cacheKey(a[k].chars, a[k].length, depth);
+        }
+    }
+    insertionSort(a, n, depth);
+}
+
+void cacheStrings(const QString* strings, qint64 first, qint64 end, CachedString* out) {
+    for (qint64 i = first; i < end; ++i) {
+        CachedString& c = out[i];
+        c.chars = strings[i].utf16();
+        c.length = strings[i].size();
+        c.index = i;
+        c.key = cacheKey(c.chars, c.length, 0);
+    }
+}
+
+// lcp[i] = common prefix of a[i - 1] and a[i]; lcp[0] = 0.
+void computeLcps(const CachedString* a, qint64 n, int* lcp) {
+    if (n > 0) lcp[0] = 0;
+    for (qint64 i = 1; i < n; ++i) {
+        lcp[i] = commonPrefix(a[i - 1], a[i], 0);
+    }
+}
+
+// Merges sorted runs a and b with their LCP arrays into out / outLcp.
+//
+// ha and hb are the common prefixes of the next candidate from each run
+// with the last string written. The candidate with the longer one is the
+// smaller (both are >= the last string, and it agrees with it further);
+// only on a tie are characters compared, starting past the shared prefix.
+// On entry they describe a[0] and b[0]: 0 for a merge starting an output.
+void lcpMerge(const CachedString* a, const int* aLcp, qint64 na,
+              const CachedString* b, const int* bLcp, qint64 nb,
+              int ha, int hb, CachedString* out, int* outLcp) {
+    qint64 i = 0;
+    qint64 j = 0;
+    qint64 k = 0;
+    while (i < na && j < nb) {
+        if (ha > hb) {
+            out[k] = a[i];
+            outLcp[k++] = ha;
+            if (++i < na) ha = aLcp[i];
+        } else if (ha < hb) {
+            out[k] = b[j];
+            outLcp[k++] = hb;
+            if (++j < nb) hb = bLcp[j];
+        } else {
+            int prefix = commonPrefix(a[i], b[j], ha);
+            if (!lessAfterPrefix(b[j], a[i], prefix)) {
+                out[k] = a[i];
+                outLcp[k++] = ha;
+                hb = prefix; // b[j] against the new last string, a[i]
+                if (++i < na) ha = aLcp[i];
+            } else {
+                out[k] = b[j];
+                outLcp[k++] = hb;
+                ha = prefix;
+                if (++j < nb) hb = bLcp[j];
+            }
+        }
+    }
+    for (bool first = true; i < na; ++i, first = false) {
+        out[k] = a[i];
+        outLcp[k++] = first ? ha : aLcp[i];
+    }
+    for (bool first = true; j < nb; ++j, first = false) {
+        out[k] = b[j];
+        outLcp[k++] = first ? hb : bLcp[j];
+    }
+}
+
+// Writes output positions [outFirst, outEnd) of the merge of the sorted
+// runs src[first, middle) and src[middle, end), as lcpMerge() would have.
+// The piece's inputs are found by co-ranking, and its first string's LCP
+// with the string before it by comparing the two directly.
+void lcpMergePiece(const CachedString* src, const int* srcLcp, qint64 first, qint64 middle, qint64 end,
+                   qint64 outFirst, qint64 outEnd, CachedString* dst, int* dstLcp) {
+    std::vector<SortedRun<CachedString>> runs = {{src + first, src + middle}, {src + middle, src + end}};
+    std::vector<qint64> cursor = coRank(runs, outFirst - first, CachedStringLess());
+    std::vector<qint64> limit = coRank(runs, outEnd - first, CachedStringLess());
+    const CachedString* a = src + first + cursor[0];
+    const CachedString* b = src + middle + cursor[1];
+    qint64 na = limit[0] - cursor[0];
+    qint64 nb = limit[1] - cursor[1];
+
+    int ha = 0;
+    int hb = 0;
+    if (outFirst > first) {
+        // The string written last: of a[-1] and b[-1], the later in merge
+        // order, which is b[-1] on a tie.
+        const CachedString* last;
+        if (cursor[0] == 0) last = b - 1;
+        else if (cursor[1] == 0) last = a - 1;
+        else last = CachedStringLess()(b[-1], a[-1]) ? a - 1 : b - 1;
+        if (na > 0) ha = commonPrefix(*a, *last, 0);
+        if (nb > 0) hb = commonPrefix(*b, *last, 0);
+    }
+    lcpMerge(a, srcLcp + (a - src), na, b, srcLcp + (b - src), nb, ha, hb,
+             dst + outFirst, dstLcp + outFirst);
+}
+
+} // namespace
+
+void sortStrings(QString* begin, QString* end) {
+    qint64 n = end - begin;
+    if (n < 2) return;
+    std::vector<CachedString> cached((size_t)n);
+    cacheStrings(begin, 0, n, cached.data());
+    multikeyQuicksort(cached.data(), n, 0);
+
+    std::vector<QString> sorted((size_t)n);
+    for (qint64 i = 0; i < n; ++i) {
+        sorted[i] = std::move(begin[cached[i].index]); // Moves keep the character buffers
+    }
+    std::move(sorted.begin(), sorted.end(), begin);
+}
+
+void ParallelStringSorter::sort(std::vector<QString>* strings, AsyncJob* job) {
+    const qint64 n = (qint64)strings->size();
+    int threads = m_pool->maxThreadCount();
+    if (n < PARALLEL_THRESHOLD || threads <= 1) {
+        sortStrings(strings->data(), strings->data() + n);
+        return;
+    }
+
+    // A power of two of runs makes the merge tree perfect, so every run of
+    // level l lives in buffer l % 2.
+    int levels = 0;
+    while ((1 << levels) < threads) ++levels;
+    const int runs = 1 << levels;
+    std::vector<qint64> bounds(runs + 1);
+    for (int r = 0; r <= runs; ++r) bounds[r] = n * r / runs;
+
+    std::vector<CachedString> cached[2] = {std::vector<CachedString>((size_t)n), std::vector<CachedString>((size_t)n)};
+    std::vector<int> lcps[2] = {std::vector<int>((size_t)n), std::vector<int>((size_t)n)};
+    const QString* input = strings->data();
+
+    {
+        TaskGraph graph(m_pool, job);
+        std::vector<TaskGraph::NodeId> level;
+        for (int r = 0; r < runs; ++r) {
+            qint64 first = bounds[r];
+            qint64 end = bounds[r + 1];
+            CachedString* a = cached[0].data();
+            int* lcp = lcps[0].data();
+            level.push_back(graph.add([input, a, lcp, first, end]() {
+                cacheStrings(input, first, end, a);
+                multikeyQuicksort(a + first, end - first, 0);
+                computeLcps(a + first, end - first, lcp + first);
+            }, std::vector<TaskGraph::NodeId>(), "String run sort"));
+        }
+
+        // Each merge of level l is cut into 2^l pieces by co-ranking, so
+        // every level runs 'runs' pieces and the last merge is not left to
+        // one thread. A piece waits for all pieces of the two merges it
+        // reads from.
+        std::vector<std::vector<TaskGraph::NodeId>> merges;
+        for (TaskGraph::NodeId id : level) merges.push_back({id});
+        for (int l = 1; l <= levels; ++l) {
+            const int width = 1 << l; // Input runs covered by one merge at this level
+            CachedString* src = cached[(l - 1) % 2].data();
+            int* srcLcp = lcps[(l - 1) % 2].data();
+            CachedString* dst = cached[l % 2].data();
+            int* dstLcp = lcps[l % 2].data();
+            std::vector<std::vector<TaskGraph::NodeId>> next;
+            for (int m = 0; m < (int)merges.size() / 2; ++m) {
+                qint64 first = bounds[m * width];
+                qint64 middle = bounds[m * width + width / 2];
+                qint64 end = bounds[(m + 1) * width];
+                std::vector<TaskGraph::NodeId> inputs = merges[2 * m];
+                inputs.insert(inputs.end(), merges[2 * m + 1].begin(), merges[2 * m + 1].end());
+                std::vector<TaskGraph::NodeId> pieces;
+                for (int p = 0; p < width; ++p) {
+                    qint64 outFirst = first + (end - first) * p / width;
+                    qint64 outEnd = first + (end - first) * (p + 1) / width;
+                    pieces.push_back(graph.add([src, srcLcp, dst, dstLcp, first, middle, end, outFirst, outEnd]() {
+                        lcpMergePiece(src, srcLcp, first, middle, end, outFirst, outEnd, dst, dstLcp);
+                    }, inputs, "String LCP merge"));
+                }
+                next.push_back(pieces);
+            }
+            merges.swap(next);
+        }
+        graph.wait();
+    }
+    if (job && job->isCancelled()) return;
+
+    // Permute in parallel: every source index is read exactly once. Not
+    // cancellable: once strings start moving, every one has to land, or the
+    // input would be left half moved-from.
+    const CachedString* order = cached[levels % 2].data();
+    std::vector<QString> sorted((size_t)n);
+    {
+        QString* source = strings->data();
+        QString* target = sorted.data();
+        TaskGraph graph(m_pool);
+        for (int r = 0; r < runs; ++r) {
+            qint64 first = bounds[r];
+            qint64 end = bounds[r + 1];
+            graph.add([source, target, order, first, end]() {
+                for (qint64 i = first; i < end; ++i) target[i] = std::move(source[order[i].index]);
+            }, std::vector<TaskGraph::NodeId>(), "String permute");
+        }
+        graph.wait();
+    }
+    strings->swap(sorted);
+}
+
+void ParallelStringSorter::sortGlobally(std::vector<std::vector<QString>>* matrix, AsyncJob* job) {
+    qint64 total = 0;
+    for (const auto& row : *matrix) total += (qint64)row.size();
+
+    std::vector<QString> all;
+    all.reserve((size_t)total);
+    for (auto& row : *matrix) {
+        for (QString& s : row) all.push_back(std::move(s));
+    }
+    sort(&all, job);
+
+    qint64 next = 0;
+    for (auto& row : *matrix) {
+        for (QString& s : row) s = std::move(all[next++]);
+    }
+}
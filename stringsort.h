@@ -0,0 +1,51 @@
+#ifndef STRINGSORT_H
+#define STRINGSORT_H
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+class AsyncJob;
+class QThreadPool;
+
+// String sorting that does not re-compare shared prefixes, in the order of
+// QString::operator< (UTF-16 code units).
+//
+// Sequential: multikey quicksort over cached keys. Each string carries the
+// next KEY_CHARS code units from the current depth packed into one integer,
+// so partitioning is integer compares on contiguous memory. Only a group
+// whose keys are all equal advances its depth and reloads keys, so a prefix
+// shared by a group is read once per group, not once per comparison.
+//
+// Parallel: the input is split into a power-of-two number of runs sorted
+// independently, each producing its LCP array (common prefix with the
+// previous string). Runs are merged pairwise up a TaskGraph tree with an
+// LCP-aware merge, which compares characters only past the longer of the
+// two candidates' known prefixes with the last string written. Each merge is
+// cut into output pieces by co-ranking, so every level of the tree keeps the
+// whole pool busy.
+
+// Sorts [begin, end) on the calling thread.
+void sortStrings(QString* begin, QString* end);
+
+class ParallelStringSorter
+{
+public:
+    // Inputs below this size are sorted by sortStrings() on the calling thread.
+    static const qint64 PARALLEL_THRESHOLD = 16 * 1024;
+
+    explicit ParallelStringSorter(QThreadPool* pool) : m_pool(pool) {}
+
+    // Sorts one sequence with the whole pool. Left unchanged if the job is
+    // cancelled.
+    void sort(std::vector<QString>* strings, AsyncJob* job = nullptr);
+
+    // Sorts all cells of the matrix as one sequence and writes them back in
+    // row-major order; row lengths are kept.
+    void sortGlobally(std::vector<std::vector<QString>>* matrix, AsyncJob* job = nullptr);
+
+private:
+    QThreadPool* m_pool;
+};
+
+#endif // STRINGSORT_H
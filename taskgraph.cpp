@@ -0,0 +1,145 @@
+#include "taskgraph.h"
+#include "asyncjob.h"
+#include "numaplacement.h"
+#include "tasktrace.h"
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <climits>
+#include <typeinfo>
+
+class TaskGraph::NodeRunner : public QRunnable {
+private:
+    TaskGraph* m_graph;
+    NodeId m_id;
+
+public:
+    NodeRunner(TaskGraph* graph, NodeId id) : m_graph(graph), m_id(id) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        m_graph->runNode(m_id);
+    }
+};
+
+TaskGraph::TaskGraph(QThreadPool* pool, AsyncJob* job)
+    : m_pool(pool), m_job(job), m_reportsProgress(true), m_unfinished(0), m_finished(0), m_dispatched(0) {}
+
+TaskGraph::~TaskGraph() {
+    wait();
+}
+
+bool TaskGraph::isCancelled() const {
+    return m_job && m_job->isCancelled();
+}
+
+TaskGraph::NodeId TaskGraph::add(QRunnable* task, const std::vector<NodeId>& dependencies) {
+    const char* traceName = TaskTrace::isEnabled() ? TaskTrace::typeName(typeid(*task)) : nullptr;
+    return addNode([this, task]() {
+        bool ownsTask = task->autoDelete();
+        if (!isCancelled()) task->run();
+        if (ownsTask) delete task;
+    }, dependencies, traceName);
+}
+
+TaskGraph::NodeId TaskGraph::add(std::function<void()> work, const std::vector<NodeId>& dependencies, const char* traceName) {
+    return addNode([this, work]() {
+        if (!isCancelled()) work();
+    }, dependencies, traceName);
+}
+
+TaskGraph::NodeId TaskGraph::addNode(std::function<void()> work, const std::vector<NodeId>& dependencies, const char* traceName) {
+    QMutexLocker locker(&m_mutex);
+    NodeId id = (NodeId)m_nodes.size();
+    m_nodes.push_back(Node{std::move(work), std::vector<NodeId>(), 0, false, traceName, 0});
+    m_unfinished++;
+
+    for (NodeId dep : dependencies) {
+        if (!m_nodes[dep].finished) {
+            m_nodes[dep].dependents.push_back(id);
+            m_nodes[id].pendingDependencies++;
+        }
+    }
+    if (m_nodes[id].pendingDependencies == 0) {
+        enqueue(id);
+    }
+    return id;
+}
+
+void TaskGraph::enqueue(NodeId id) {
+    if (m_nodes[id].traceName && TaskTrace::isEnabled()) {
+        m_nodes[id].enqueuedNs = TaskTrace::now();
+    }
+    m_ready.push_back(id);
+    dispatch();
+}
+
+void TaskGraph::dispatch() {
+    // Read on every call, so a share that changes mid-graph applies from
+    // the next node on.
+    int limit = m_job ? std::max(1, m_job->threadBudget(m_pool->maxThreadCount())) : INT_MAX;
+    while (!m_ready.empty() && m_dispatched < limit) {
+        NodeId id = m_ready.front();
+        m_ready.pop_front();
+        m_dispatched++;
+        m_pool->start(new NodeRunner(this, id), m_job ? (int)m_job->priority() : 0);
+    }
+}
+
+void TaskGraph::runNode(NodeId id) {
+    NumaPlacement::pinCurrentWorker();
+
+    std::function<void()> work;
+    const char* traceName;
+    qint64 enqueuedNs;
+    {
+        QMutexLocker locker(&m_mutex);
+        work.swap(m_nodes[id].work); // Releases captures as soon as the node is done
+        traceName = m_nodes[id].traceName;
+        enqueuedNs = m_nodes[id].enqueuedNs;
+    }
+
+    if (traceName && TaskTrace::isEnabled()) {
+        qint64 startNs = TaskTrace::now();
+        work();
+        TaskTrace::record(traceName, enqueuedNs ? enqueuedNs : startNs, startNs, TaskTrace::now());
+    } else {
+        work();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_dispatched--;
+    Node& node = m_nodes[id];
+    node.finished = true;
+    for (NodeId dependent : node.dependents) {
+        if (--m_nodes[dependent].pendingDependencies == 0) {
+            enqueue(dependent);
+        }
+    }
+    node.dependents.clear();
+    dispatch();
+
+    m_finished++;
+    if (m_job && m_reportsProgress) {
+        m_job->updateProgress(m_finished, (qint64)m_nodes.size());
+    }
+    if (--m_unfinished == 0) {
+        m_allDone.wakeAll();
+    }
+}
+
+void TaskGraph::wait() {
+    QCoreApplication* app = QCoreApplication::instance();
+    bool onGuiThread = app && QThread::currentThread() == app->thread();
+    Q_ASSERT(!onGuiThread);
+    Q_UNUSED(onGuiThread);
+
+    QMutexLocker locker(&m_mutex);
+    while (m_unfinished > 0) {
+        m_allDone.wait(&m_mutex);
+    }
+}
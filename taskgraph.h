@@ -0,0 +1,83 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <deque>
+#include <functional>
+#include <vector>
+
+class AsyncJob;
+class QRunnable;
+class QThreadPool;
+
+// Dependency-driven scheduling on top of a shared QThreadPool.
+//
+// A node is handed to the pool the moment its last dependency finishes, so
+// phases overlap instead of meeting at a global waitForDone() barrier. Nodes
+// may be added at any time, including from inside a running node, which is
+// how a task schedules its own continuation.
+//
+// When constructed for an AsyncJob, nodes that have not started by the time
+// the job is cancelled are skipped, node completion is reported as the job's
+// progress for the current phase, and nodes enter the pool queue at the
+// job's priority, ahead of lower-priority jobs' nodes. At most
+// AsyncJob::threadBudget() nodes are in the pool at once; further ready
+// nodes wait in the graph, in the order they became ready, and go in as
+// running ones finish.
+//
+// Every node is timed for TaskTrace (see tasktrace.h) while tracing is on:
+// QRunnable nodes under their class name, functions under 'traceName'.
+class TaskGraph
+{
+public:
+    typedef int NodeId;
+
+    explicit TaskGraph(QThreadPool* pool, AsyncJob* job = nullptr);
+    ~TaskGraph(); // Waits for all nodes
+
+    // Graphs that grow while running (continuations) have no meaningful
+    // node total; their owners report progress themselves.
+    void setReportsProgress(bool enabled) { m_reportsProgress = enabled; }
+    bool isCancelled() const;
+
+    // Takes ownership of 'task' if it has autoDelete() set, like QThreadPool::start().
+    NodeId add(QRunnable* task, const std::vector<NodeId>& dependencies = std::vector<NodeId>());
+    NodeId add(std::function<void()> work, const std::vector<NodeId>& dependencies = std::vector<NodeId>(),
+               const char* traceName = "TaskGraph node");
+
+    // Blocks until every node (including ones added while waiting) has run.
+    // Never called on the GUI thread: graphs run on job driver threads.
+    void wait();
+
+private:
+    struct Node {
+        std::function<void()> work;
+        std::vector<NodeId> dependents;
+        int pendingDependencies;
+        bool finished;
+        const char* traceName;
+        qint64 enqueuedNs; // When handed to the pool, if tracing
+    };
+    class NodeRunner;
+
+    NodeId addNode(std::function<void()> work, const std::vector<NodeId>& dependencies, const char* traceName);
+    void enqueue(NodeId id); // Called with m_mutex held
+    void dispatch();         // Called with m_mutex held
+    void runNode(NodeId id);
+
+    QThreadPool* m_pool;
+    AsyncJob* m_job;
+    bool m_reportsProgress;
+    QMutex m_mutex;
+    QWaitCondition m_allDone;
+    std::deque<Node> m_nodes; // Only touched under m_mutex
+    int m_unfinished;
+    int m_finished;
+    std::deque<NodeId> m_ready; // Ready nodes held back by the job's thread budget
+    int m_dispatched;           // Nodes handed to the pool and not finished
+
+    Q_DISABLE_COPY(TaskGraph)
+};
+
+#endif // TASKGRAPH_H
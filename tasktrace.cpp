@@ -0,0 +1,176 @@
+#include "tasktrace.h"
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <vector>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+std::atomic<bool> TaskTrace::s_enabled(false);
+
+namespace {
+
+const int EVENTS_PER_THREAD = 64 * 1024; // 2 MB per thread that ever records
+
+struct TraceEvent {
+    const char* name;
+    qint64 enqueueNs;
+    qint64 startNs;
+    qint64 endNs;
+};
+
+// Written only by its own thread; readers see the first 'count' events.
+struct ThreadBuffer {
+    int tid;
+    std::atomic<int> count;
+    std::atomic<qint64> dropped;
+    std::vector<TraceEvent> events;
+
+    explicit ThreadBuffer(int id) : tid(id), count(0), dropped(0), events(EVENTS_PER_THREAD) {}
+};
+
+// Buffers are never freed: pool threads may expire, but their events stay
+// exportable.
+QMutex g_registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+std::map<std::type_index, std::string> g_typeNames;
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+ThreadBuffer* threadBuffer() {
+    if (!t_buffer) {
+        QMutexLocker locker(&g_registryMutex);
+        g_buffers.emplace_back(new ThreadBuffer((int)g_buffers.size() + 1));
+        t_buffer = g_buffers.back().get();
+    }
+    return t_buffer;
+}
+
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+void appendJsonString(QByteArray& out, const char* text) {
+    out += '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') out += '\\';
+        out += *c;
+    }
+    out += '"';
+}
+
+// Trace timestamps are microseconds; keep sub-microsecond precision.
+QByteArray micros(qint64 ns) {
+    return QByteArray::number((double)ns / 1000.0, 'f', 3);
+}
+
+} // namespace
+
+qint64 TaskTrace::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_epoch).count();
+}
+
+void TaskTrace::record(const char* name, qint64 enqueueNs, qint64 startNs, qint64 endNs) {
+    ThreadBuffer* buffer = threadBuffer();
+    int n = buffer->count.load(std::memory_order_relaxed);
+    if (n >= EVENTS_PER_THREAD) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[n] = TraceEvent{name, enqueueNs, startNs, endNs};
+    buffer->count.store(n + 1, std::memory_order_release);
+}
+
+const char* TaskTrace::typeName(const std::type_info& type) {
+    QMutexLocker locker(&g_registryMutex);
+    auto it = g_typeNames.find(std::type_index(type));
+    if (it == g_typeNames.end()) {
+        std::string name = type.name();
+#ifdef __GNUG__
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+        if (status == 0 && demangled) name = demangled;
+        std::free(demangled);
+#endif
+        it = g_typeNames.insert(std::make_pair(std::type_index(type), name)).first;
+    }
+    return it->second.c_str(); // Map nodes are stable
+}
+
+void TaskTrace::clear() {
+    QMutexLocker locker(&g_registryMutex);
+    for (const auto& buffer : g_buffers) {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+qint64 TaskTrace::eventCount() {
+    QMutexLocker locker(&g_registryMutex);
+    qint64 total = 0;
+    for (const auto& buffer : g_buffers) total += buffer->count.load(std::memory_order_acquire);
+    return total;
+}
+
+qint64 TaskTrace::droppedCount() {
+    QMutexLocker locker(&g_registryMutex);
+    qint64 total = 0;
+    for (const auto& buffer : g_buffers) total += buffer->dropped.load(std::memory_order_relaxed);
+    return total;
+}
+
+QByteArray TaskTrace::toChromeJson() {
+    QMutexLocker locker(&g_registryMutex);
+    QByteArray out;
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&out, &first]() {
+        if (!first) out += ",\n";
+        first = false;
+    };
+
+    qint64 asyncId = 0;
+    for (const auto& buffer : g_buffers) {
+        int count = buffer->count.load(std::memory_order_acquire);
+        if (count == 0) continue;
+        QByteArray tid = QByteArray::number(buffer->tid);
+
+        separator();
+        out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + tid
+             + ",\"args\":{\"name\":\"Thread " + tid + "\"}}";
+
+        for (int i = 0; i < count; ++i) {
+            const TraceEvent& e = buffer->events[i];
+            separator();
+            out += "{\"ph\":\"X\",\"cat\":\"task\",\"name\":";
+            appendJsonString(out, e.name);
+            out += ",\"pid\":1,\"tid\":" + tid + ",\"ts\":" + micros(e.startNs) + ",\"dur\":" + micros(e.endNs - e.startNs)
+                 + ",\"args\":{\"queuedUs\":" + micros(e.startNs - e.enqueueNs) + "}}";
+
+            QByteArray id = QByteArray::number(++asyncId);
+            separator();
+            out += "{\"ph\":\"b\",\"cat\":\"queued\",\"name\":";
+            appendJsonString(out, e.name);
+            out += ",\"pid\":1,\"id\":" + id + ",\"ts\":" + micros(e.enqueueNs) + "}";
+            separator();
+            out += "{\"ph\":\"e\",\"cat\":\"queued\",\"name\":";
+            appendJsonString(out, e.name);
+            out += ",\"pid\":1,\"id\":" + id + ",\"ts\":" + micros(e.startNs) + "}";
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+bool TaskTrace::writeChromeJson(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QByteArray json = toChromeJson();
+    return file.write(json) == json.size();
+}
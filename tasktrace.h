@@ -0,0 +1,52 @@
+#ifndef TASKTRACE_H
+#define TASKTRACE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+#include <typeinfo>
+
+// Timeline of every task run through a TaskGraph, exported as Chrome trace
+// JSON (chrome://tracing, ui.perfetto.dev).
+//
+// Each thread appends to its own fixed-size event buffer, so recording an
+// event is a clock read and a store with no locks or shared cache lines; the
+// only lock is taken once per thread, when its buffer is first registered.
+// A full buffer drops further events and counts them rather than growing.
+//
+// Recording is off by default and costs one relaxed load per task when off.
+// clear() and the export functions must only run while no tasks are running,
+// e.g. between jobs.
+class TaskTrace
+{
+public:
+    static void setEnabled(bool enabled) { s_enabled.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Nanoseconds on a monotonic clock shared by all threads.
+    static qint64 now();
+
+    // One task: handed to the pool at enqueueNs, ran from startNs to endNs on
+    // the calling thread. 'name' must outlive the trace (a literal, or from
+    // typeName()).
+    static void record(const char* name, qint64 enqueueNs, qint64 startNs, qint64 endNs);
+
+    // Readable, interned name for a task class, e.g. "SortTask<int, std::less<int> >".
+    static const char* typeName(const std::type_info& type);
+
+    static void clear();
+    static qint64 eventCount();
+    static qint64 droppedCount();
+
+    // Each task is a complete ("X") event on its worker's track; its time in
+    // the queue is an async span on a separate "queued" track, since queue
+    // spans overlap and do not belong to any one thread.
+    static QByteArray toChromeJson();
+    static bool writeChromeJson(const QString& path);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+#endif // TASKTRACE_H
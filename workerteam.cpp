@@ -0,0 +1,170 @@
+#include "workerteam.h"
+#include "numaplacement.h"
+#include "tasktrace.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <climits>
+#include <vector>
+#if defined(Q_OS_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() do {} while (0)
+#endif
+
+namespace {
+
+// Polls before sleeping: a few microseconds, about what a balanced pass
+// leaves between the first and the last member to arrive.
+const int SPIN_ITERATIONS = 2000;
+
+// How long run() waits for its recruits to start before closing the team:
+// a thread wake-up several times over.
+const qint64 JOIN_WAIT_NS = 200 * 1000;
+
+// Set in m_joined when the team closes; recruits that start later stay out.
+const int CLOSED = 1 << 30;
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex words are plain ints");
+
+// Returns once *word != value.
+void waitWhileEqual(std::atomic<int>* word, int value) {
+    for (int i = 0; i < SPIN_ITERATIONS; ++i) {
+        if (word->load(std::memory_order_acquire) != value) return;
+        CPU_RELAX();
+    }
+    while (word->load(std::memory_order_acquire) == value) {
+#if defined(Q_OS_LINUX)
+        syscall(SYS_futex, reinterpret_cast<int*>(word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#elif defined(Q_OS_WIN)
+        WaitOnAddress(word, &value, sizeof(int), INFINITE);
+#else
+        QThread::yieldCurrentThread();
+#endif
+    }
+}
+
+void wakeAll(std::atomic<int>* word) {
+#if defined(Q_OS_LINUX)
+    syscall(SYS_futex, reinterpret_cast<int*>(word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#elif defined(Q_OS_WIN)
+    WakeByAddressAll(word);
+#else
+    Q_UNUSED(word);
+#endif
+}
+
+} // namespace
+
+class WorkerTeam::Member : public QRunnable
+{
+public:
+    // Owned by run(), which may withdraw it from the pool queue.
+    Member(WorkerTeam* team, const std::function<void(int, int)>* body)
+        : m_team(team), m_body(body) {
+        setAutoDelete(false);
+    }
+
+    void run() override { m_team->runMember(m_body); }
+
+private:
+    WorkerTeam* m_team;
+    const std::function<void(int, int)>* m_body;
+};
+
+void WorkerTeam::run(int maxMembers, const std::function<void(int member, int members)>& body) {
+    m_joined.store(1, std::memory_order_relaxed); // The caller
+    m_started.store(0, std::memory_order_relaxed);
+    m_arrived.store(0, std::memory_order_relaxed);
+    m_generation.store(0, std::memory_order_relaxed);
+    m_running = 0;
+
+    // A member beyond the core count can only be preempted while the others
+    // wait for it at every barrier, so the team never exceeds the cores.
+    maxMembers = std::min(maxMembers, std::max(1, QThread::idealThreadCount()));
+
+    // Recruit free pool threads only; tryStart() fails instead of queueing.
+    // A reused idle thread still takes the head of the pool queue, which may
+    // be a higher-priority runnable, so a recruit is not yet a member.
+    std::vector<Member*> recruits;
+    while ((int)recruits.size() + 1 < maxMembers) {
+        {
+            QMutexLocker locker(&m_doneMutex);
+            m_running++;
+        }
+        Member* member = new Member(this, &body);
+        if (!m_pool->tryStart(member)) {
+            delete member;
+            QMutexLocker locker(&m_doneMutex);
+            m_running--;
+            break;
+        }
+        recruits.push_back(member);
+    }
+
+    // Close the team once every recruit is in or the wait runs out, and size
+    // the barrier from the members that are in. Recruits still queued are
+    // withdrawn; ones that start after closing skip the body.
+    const int expected = 1 + (int)recruits.size();
+    QElapsedTimer waiting;
+    waiting.start();
+    while (m_joined.load(std::memory_order_acquire) < expected && waiting.nsecsElapsed() < JOIN_WAIT_NS) {
+        QThread::yieldCurrentThread();
+    }
+    m_members = m_joined.fetch_or(CLOSED, std::memory_order_acq_rel);
+    for (Member* member : recruits) {
+        if (m_pool->tryTake(member)) {
+            QMutexLocker locker(&m_doneMutex);
+            m_running--;
+        }
+    }
+    m_started.store(1, std::memory_order_release);
+    wakeAll(&m_started);
+
+    body(0, m_members); // The caller is member 0
+
+    {
+        QMutexLocker locker(&m_doneMutex);
+        while (m_running > 0) m_allDone.wait(&m_doneMutex);
+    }
+    for (Member* member : recruits) delete member;
+}
+
+void WorkerTeam::runMember(const std::function<void(int, int)>* body) {
+    qint64 enqueuedNs = TaskTrace::isEnabled() ? TaskTrace::now() : 0;
+    // Members are numbered in the order they start.
+    int member = m_joined.fetch_add(1, std::memory_order_acq_rel);
+    if (!(member & CLOSED)) {
+        waitWhileEqual(&m_started, 0); // m_members is final past this point
+        NumaPlacement::pinCurrentWorker();
+        qint64 startNs = enqueuedNs ? TaskTrace::now() : 0;
+        (*body)(member, m_members);
+        if (enqueuedNs) TaskTrace::record("WorkerTeam member", enqueuedNs, startNs, TaskTrace::now());
+    }
+
+    QMutexLocker locker(&m_doneMutex);
+    if (--m_running == 0) m_allDone.wakeAll();
+}
+
+void WorkerTeam::barrier() {
+    int generation = m_generation.load(std::memory_order_acquire);
+    if (m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_members) {
+        // Last to arrive: reset for the next barrier before releasing anyone into it.
+        m_arrived.store(0, std::memory_order_relaxed);
+        m_generation.fetch_add(1, std::memory_order_release);
+        wakeAll(&m_generation);
+    } else {
+        waitWhileEqual(&m_generation, generation);
+    }
+}
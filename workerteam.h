@@ -0,0 +1,97 @@
+#ifndef WORKERTEAM_H
+#define WORKERTEAM_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <new>
+
+class QThreadPool;
+
+// A fixed group of threads running one body together, for iterative kernels
+// whose passes are too short to pay an enqueue per chunk per pass.
+//
+// run() executes body(member, members) on the calling thread and on every
+// pool thread that is free at that moment; threads that are busy are simply
+// not recruited, so a team never waits for a thread that cannot come. A
+// recruit only counts once it has actually started: one that is still
+// queued when the team closes (an idle thread may pick a higher-priority
+// runnable first) is withdrawn. Each member keeps its own share of the work
+// across passes and meets the others at barrier() between them.
+class WorkerTeam
+{
+public:
+    explicit WorkerTeam(QThreadPool* pool)
+        : m_pool(pool), m_members(0), m_joined(0), m_started(0), m_arrived(0), m_generation(0), m_running(0) {}
+
+    // At most maxMembers members, including the caller, and no more than
+    // QThread::idealThreadCount(); 'members' is how many started in time.
+    // Returns once every member's body has returned.
+    void run(int maxMembers, const std::function<void(int member, int members)>& body);
+
+    // Waits until all members of the running team have arrived. Spins
+    // briefly, since passes are usually balanced, then sleeps on a futex
+    // (WaitOnAddress on Windows) instead of burning the core.
+    void barrier();
+
+private:
+    class Member;
+
+    void runMember(const std::function<void(int, int)>* body);
+
+    QThreadPool* m_pool;
+    int m_members;
+    std::atomic<int> m_joined;     // Members that have started, | CLOSED once m_members is taken
+    std::atomic<int> m_started;    // 0 until m_members is final
+    std::atomic<int> m_arrived;    // Members at the current barrier
+    std::atomic<int> m_generation; // Barriers completed
+    QMutex m_doneMutex;
+    QWaitCondition m_allDone;
+    int m_running; // Recruited members still in their body, under m_doneMutex
+
+    Q_DISABLE_COPY(WorkerTeam)
+};
+
+// One T per cache line, so per-worker counters written in the same pass do
+// not invalidate each other's lines (adjacent QAtomicInts share one).
+template <typename T>
+class PaddedSlots
+{
+public:
+    static const int CACHE_LINE = 64;
+
+    explicit PaddedSlots(int count = 0) : m_count(0), m_base(nullptr) { resize(count); }
+    ~PaddedSlots() { destroy(); }
+
+    // Reconstructs every slot as T().
+    void resize(int count) {
+        static_assert(sizeof(T) <= CACHE_LINE, "PaddedSlots holds at most one cache line per slot");
+        destroy();
+        m_storage.reset(new char[(size_t)(count + 1) * CACHE_LINE]);
+        quintptr address = reinterpret_cast<quintptr>(m_storage.get());
+        m_base = reinterpret_cast<char*>((address + CACHE_LINE - 1) & ~(quintptr)(CACHE_LINE - 1));
+        m_count = count;
+        for (int i = 0; i < count; ++i) new (m_base + (size_t)i * CACHE_LINE) T();
+    }
+
+    int size() const { return m_count; }
+    T& operator[](int i) { return *reinterpret_cast<T*>(m_base + (size_t)i * CACHE_LINE); }
+    const T& operator[](int i) const { return *reinterpret_cast<const T*>(m_base + (size_t)i * CACHE_LINE); }
+
+private:
+    void destroy() {
+        for (int i = 0; i < m_count; ++i) (*this)[i].~T();
+        m_count = 0;
+    }
+
+    int m_count;
+    std::unique_ptr<char[]> m_storage;
+    char* m_base; // First cache-line boundary in m_storage
+
+    Q_DISABLE_COPY(PaddedSlots)
+};
+
+#endif // WORKERTEAM_H
@@ -0,0 +1,537 @@
+#include "workloads.h"
+#include "asyncjob.h"
+#include "counterrng.h"
+#include "outputlog.h"
+#include "parallelfor.h"
+#include "parallelsort.h"
+#include "parallelverify.h"
+#include "simddecrement.h"
+#include "stringmatrix.h"
+#include "stringsort.h"
+#include "taskgraph.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <algorithm>
+
+// === Task 1: number sort input ===
+
+class RandomGenTask : public QRunnable {
+private:
+    OverwriteVector<int>* data;
+    int startIndex;
+    int endIndex;
+    CounterRng rng;
+    quint64 indexBase; // Counter of data[0], so consecutive batches draw fresh values
+    int maxValue;
+
+public:
+    RandomGenTask(OverwriteVector<int>* vec, int start, int end, const CounterRng& generator, quint64 firstIndex,
+                  int maxVal)
+        : data(vec), startIndex(start), endIndex(end), rng(generator), indexBase(firstIndex), maxValue(maxVal) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        rng.fillInts(data->data() + startIndex, endIndex - startIndex, indexBase + startIndex, 1, maxValue);
+    }
+};
+
+void generateRandomInts(OverwriteVector<int>* data, QThreadPool* pool, quint64 seed, quint64 firstIndex, int maxValue,
+                        AsyncJob* job) {
+    if (job) job->beginPhase("Generating random data");
+    CounterRng rng(seed, CounterRng::SortDataStream);
+    parallelFor(pool, 0, (qint64)data->size(), Grain::automatic(MIN_ELEMENT_GRAIN), [&](qint64 first, qint64 end) {
+        RandomGenTask(data, (int)first, (int)end, rng, firstIndex, maxValue).run();
+    }, job, "RandomGenTask");
+}
+
+void ingestRandomInts(ParallelSorter<int>* sorter, OverwriteVector<int>* data, quint64 seed, quint64 firstIndex,
+                      int maxValue, SliceSortCheck<int>* check, AsyncJob* job) {
+    CounterRng rng(seed, CounterRng::SortDataStream);
+    sorter->pipelinedSort(data, [&](int* begin, int* end, qint64 first) {
+        rng.fillInts(begin, end - begin, firstIndex + (quint64)first, 1, maxValue);
+        check->addInput(begin, end);
+    }, [check](const int* begin, const int* end, qint64 first) {
+        check->addOutput(begin, end, first);
+    }, job);
+}
+
+void printSample(const BoundedIntVector& vec, const QString& label) {
+    // Widened copies of the ends only; the vector itself may be narrow.
+    qint64 size = vec.size();
+    OverwriteVector<int> ends;
+    for (qint64 i = 0; i < std::min<qint64>(10, size); ++i) ends.push_back(vec.at(i));
+    for (qint64 i = std::max<qint64>(10, size - 10); i < size; ++i) ends.push_back(vec.at(i));
+    printSample(ends, label);
+}
+
+void printSample(const OverwriteVector<int>& vec, const QString& label) {
+    appendToOutput(label);
+    QString firstElements = "First 10 elements: ";
+    int firstCount = std::min(10, (int)vec.size());
+    for (int i = 0; i < firstCount; i++) {
+        firstElements += QString::number(vec[i]);
+        if (i < firstCount - 1) firstElements += ", ";
+    }
+    appendToOutput(firstElements);
+
+    if (vec.empty()) return;
+
+    QString lastElements = "Last 10 elements: ";
+    int lastCount = std::min(10, (int)vec.size());
+    for (size_t i = std::max(0, (int)vec.size() - lastCount); i < vec.size(); i++) {
+        lastElements += QString::number(vec[i]);
+        if (i < vec.size() - 1) lastElements += ", ";
+    }
+    appendToOutput(lastElements);
+}
+
+
+// === Task 2: String Matrix Population and Sorting ===
+
+static const char STRING_CHARACTERS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+static const int STRING_CHARACTER_COUNT = sizeof(STRING_CHARACTERS) - 1;
+
+// Character k of cell (r, c) in a rows x cols matrix of 'width'-char strings
+// is character ((r * cols + c) * width + k) of the string stream, for both
+// storages, so one seed gives the QString and packed matrices the same cells.
+static void fillStringCharacters(const CounterRng& rng, char* out, qint64 count, quint64 firstChar) {
+    rng.fillChars(out, count, firstChar, STRING_CHARACTERS, STRING_CHARACTER_COUNT);
+}
+
+class PopulateStringRowTask : public QRunnable {
+private:
+    std::vector<std::vector<QString>>* m_matrix;
+    int m_rowIndex;
+    int m_numCols;
+    int m_stringLength;
+    CounterRng m_rng;
+
+public:
+    PopulateStringRowTask(std::vector<std::vector<QString>>* matrix, int rowIndex, int numCols, int stringLength,
+                          const CounterRng& rng)
+        : m_matrix(matrix), m_rowIndex(rowIndex), m_numCols(numCols), m_stringLength(stringLength), m_rng(rng) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        // The whole row's characters in one pass, then one allocation per cell.
+        std::vector<char> chars((size_t)m_numCols * m_stringLength);
+        fillStringCharacters(m_rng, chars.data(), (qint64)chars.size(), (quint64)m_rowIndex * chars.size());
+        std::vector<QString>& row = (*m_matrix)[m_rowIndex];
+        row.resize(m_numCols);
+        for (int j = 0; j < m_numCols; ++j) {
+            row[j] = QString::fromLatin1(chars.data() + (qint64)j * m_stringLength, m_stringLength);
+        }
+    }
+};
+
+class SortStringRowTask : public QRunnable {
+private:
+    std::vector<std::vector<QString>>* m_matrix;
+    int m_rowIndex;
+
+public:
+    SortStringRowTask(std::vector<std::vector<QString>>* matrix, int rowIndex)
+        : m_matrix(matrix), m_rowIndex(rowIndex) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        std::vector<QString>& row = (*m_matrix)[m_rowIndex];
+        sortStrings(row.data(), row.data() + row.size());
+    }
+};
+
+void StringMatrixProcessor::populate(quint64 seed) {
+    appendToOutput(QString("Populating %1x%2 string matrix with %3-char strings...").arg(m_numRows).arg(m_numCols).arg(m_stringLength));
+    if (m_job) m_job->beginPhase("Populating string matrix");
+    CounterRng rng(seed, CounterRng::StringDataStream);
+    parallelFor(m_pool, 0, m_numRows, Grain::automatic(), [&](qint64 first, qint64 end) {
+        for (qint64 i = first; i < end; ++i) {
+            PopulateStringRowTask(m_matrix, (int)i, m_numCols, m_stringLength, rng).run();
+        }
+    }, m_job, "PopulateStringRowTask");
+    appendToOutput("String matrix population complete.");
+}
+
+void StringMatrixProcessor::sortRows() {
+    appendToOutput(QString("Sorting %1 rows of string matrix...").arg(m_numRows));
+    if (m_job) m_job->beginPhase("Sorting string matrix rows");
+    parallelFor(m_pool, 0, m_numRows, Grain::automatic(), [this](qint64 first, qint64 end) {
+        for (qint64 i = first; i < end; ++i) {
+            SortStringRowTask(m_matrix, (int)i).run();
+        }
+    }, m_job, "SortStringRowTask");
+    appendToOutput("String matrix row sorting complete.");
+}
+
+void StringMatrixProcessor::sortGlobally() {
+    appendToOutput(QString("Sorting all %1 strings of the matrix as one sequence...").arg((qint64)m_numRows * m_numCols));
+    if (m_job) m_job->beginPhase("Sorting string matrix globally");
+    ParallelStringSorter(m_pool).sortGlobally(m_matrix, m_job);
+    appendToOutput("String matrix global sorting complete.");
+}
+
+class PopulatePackedRowsTask : public QRunnable {
+private:
+    PackedStringMatrix* m_matrix;
+    int m_firstRow;
+    int m_endRow;
+    CounterRng m_rng;
+
+public:
+    PopulatePackedRowsTask(PackedStringMatrix* matrix, int firstRow, int endRow, const CounterRng& rng)
+        : m_matrix(matrix), m_firstRow(firstRow), m_endRow(endRow), m_rng(rng) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        // Rows are contiguous, so the whole block is one run of characters.
+        qint64 count = (qint64)(m_endRow - m_firstRow) * m_matrix->cols() * m_matrix->width();
+        quint64 firstChar = (quint64)m_firstRow * m_matrix->cols() * m_matrix->width();
+        fillStringCharacters(m_rng, m_matrix->cell(m_firstRow, 0), count, firstChar);
+    }
+};
+
+class SortPackedRowsTask : public QRunnable {
+private:
+    PackedStringMatrix* m_matrix;
+    int m_firstRow;
+    int m_endRow;
+
+public:
+    SortPackedRowsTask(PackedStringMatrix* matrix, int firstRow, int endRow)
+        : m_matrix(matrix), m_firstRow(firstRow), m_endRow(endRow) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        m_matrix->sortRows(m_firstRow, m_endRow);
+    }
+};
+
+void PackedStringMatrixProcessor::populate(quint64 seed) {
+    appendToOutput(QString("Populating packed %1x%2 string matrix with %3-char strings...").arg(m_numRows).arg(m_numCols).arg(m_stringLength));
+    m_matrix->reset(m_numRows, m_numCols, m_stringLength);
+    appendToOutput(QString("Packed matrix storage: %1 KB in one buffer").arg(m_matrix->byteSize() / 1024));
+
+    if (m_job) m_job->beginPhase("Populating string matrix");
+    CounterRng rng(seed, CounterRng::StringDataStream);
+    parallelFor(m_pool, 0, m_numRows, Grain::automatic(PACKED_MIN_ROWS_PER_BLOCK), [&](qint64 first, qint64 end) {
+        PopulatePackedRowsTask(m_matrix, (int)first, (int)end, rng).run();
+    }, m_job, "PopulatePackedRowsTask");
+    appendToOutput("String matrix population complete.");
+}
+
+void PackedStringMatrixProcessor::sortRows() {
+    appendToOutput(QString("Sorting %1 rows of packed string matrix (%2)...")
+                   .arg(m_numRows)
+                   .arg(m_stringLength <= 4 ? "32-bit integer keys"
+                        : m_stringLength <= 8 ? "64-bit integer keys" : "byte comparison"));
+    if (m_job) m_job->beginPhase("Sorting string matrix rows");
+    parallelFor(m_pool, 0, m_numRows, Grain::automatic(PACKED_MIN_ROWS_PER_BLOCK), [this](qint64 first, qint64 end) {
+        SortPackedRowsTask(m_matrix, (int)first, (int)end).run();
+    }, m_job, "SortPackedRowsTask");
+    appendToOutput("String matrix row sorting complete.");
+}
+
+
+// === Task 3: Decrement Vector Elements ===
+
+// The tasks are templates over the storage type of a BoundedIntVector
+// (quint8, quint16 or int), instantiated once per width.
+
+template <typename T>
+class PopulateDecrementVectorTask : public QRunnable {
+private:
+    T* m_values;
+    int m_startIndex;
+    int m_endIndex;
+    int m_maxValue;
+    CounterRng m_rng;
+public:
+    PopulateDecrementVectorTask(T* values, int start, int end, int maxValue, const CounterRng& rng)
+        : m_values(values), m_startIndex(start), m_endIndex(end), m_maxValue(maxValue), m_rng(rng) {
+        setAutoDelete(true);
+    }
+    void run() override {
+        m_rng.fillBounded(m_values + m_startIndex, m_endIndex - m_startIndex, m_startIndex, 1, m_maxValue);
+    }
+};
+
+// Coin flips for pass p start at word p * wordsPerPass of the decrement
+// coin stream (see simddecrement.h), so both modes flip the same coins.
+
+template <typename T>
+class DecrementChunkTask : public QRunnable {
+private:
+    T* m_values;
+    int m_startIndex;
+    int m_endIndex;
+    CounterRng m_coins;
+    quint64 m_firstWord;
+    QAtomicInt* m_chunkNonZeroCount;
+
+public:
+    DecrementChunkTask(T* values, int start, int end, const CounterRng& coins, quint64 firstWord,
+                       QAtomicInt* chunkNonZeroCount)
+        : m_values(values), m_startIndex(start), m_endIndex(end), m_coins(coins), m_firstWord(firstWord),
+          m_chunkNonZeroCount(chunkNonZeroCount) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        qint64 nonZero = simdDecrementPass(m_values, m_startIndex, m_endIndex, m_coins, m_firstWord);
+        m_chunkNonZeroCount->store((int)nonZero);
+    }
+};
+
+// ActiveSet pass. While the chunk is dense it streams its whole range
+// through the vector kernel; once fewer than 1 / DENSE_FRACTION of its
+// elements are left it lists their indices, and later passes visit only
+// that list and compact it in place, so a pass costs the chunk's live
+// elements rather than its range.
+template <typename T>
+class DecrementActiveSetTask : public QRunnable {
+private:
+    // A listed element costs a gather and a coin lookup, several times a
+    // streamed one, so the list only pays once the chunk is this sparse.
+    static const int DENSE_FRACTION = 8;
+
+    T* m_values;
+    int m_startIndex;
+    int m_endIndex;
+    std::vector<int>* m_active;
+    char* m_listed; // Whether *m_active holds the chunk's live indices
+    CounterRng m_coins;
+    quint64 m_firstWord;
+    QAtomicInt* m_chunkNonZeroCount;
+
+public:
+    DecrementActiveSetTask(T* values, int start, int end, std::vector<int>* active, char* listed,
+                           const CounterRng& coins, quint64 firstWord, QAtomicInt* chunkNonZeroCount)
+        : m_values(values), m_startIndex(start), m_endIndex(end), m_active(active), m_listed(listed),
+          m_coins(coins), m_firstWord(firstWord), m_chunkNonZeroCount(chunkNonZeroCount) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        T* values = m_values;
+        if (!*m_listed) {
+            qint64 live = simdDecrementPass(values, m_startIndex, m_endIndex, m_coins, m_firstWord);
+            m_chunkNonZeroCount->store((int)live);
+            if (live * DENSE_FRACTION >= m_endIndex - m_startIndex) return;
+            m_active->clear();
+            m_active->reserve((size_t)live);
+            for (int i = m_startIndex; i < m_endIndex; ++i) {
+                if (values[i] > 0) m_active->push_back(i);
+            }
+            *m_listed = 1;
+        } else {
+            // Indices are ascending, so neighbours mostly share a coin word.
+            int* indices = m_active->data();
+            size_t live = 0;
+            quint64 word = 0;
+            qint64 wordIndex = -1;
+            for (size_t k = 0; k < m_active->size(); ++k) {
+                int i = indices[k];
+                values[i] = (T)(values[i] - (T)decrementCoin(m_coins, m_firstWord, i, &word, &wordIndex));
+                if (values[i] > 0) indices[live++] = i;
+            }
+            m_active->resize(live);
+        }
+        m_chunkNonZeroCount->store((int)m_active->size());
+    }
+};
+
+void DecrementProcessor::populateVector(int maxValue, quint64 seed) {
+    appendToOutput(QString("Populating vector of size %1 with random values up to %2 for decrement task...").arg(m_vectorSize).arg(maxValue));
+    if (m_pool->maxThreadCount() == 0) { appendToOutput("Error: Thread pool has 0 threads for population."); return; }
+
+    m_data->reset(m_vectorSize, maxValue, m_pool, m_job);
+    appendToOutput(QString("Decrement storage: %1 elements, %2 KB")
+                   .arg(BoundedIntVector::widthName(m_data->width())).arg(m_data->byteSize() / 1024));
+
+    if (m_job) m_job->beginPhase("Populating decrement vector");
+    m_coins = CounterRng(seed, CounterRng::DecrementCoinStream);
+    switch (m_data->width()) {
+    case BoundedIntVector::Width8: populateAs<quint8>(maxValue, seed); break;
+    case BoundedIntVector::Width16: populateAs<quint16>(maxValue, seed); break;
+    default: populateAs<int>(maxValue, seed); break;
+    }
+    appendToOutput("Decrement vector population complete.");
+}
+
+template <typename T>
+void DecrementProcessor::populateAs(int maxValue, quint64 seed) {
+    CounterRng rng(seed, CounterRng::DecrementDataStream);
+    T* values = m_data->data<T>();
+    parallelFor(m_pool, 0, m_vectorSize, Grain::automatic(MIN_ELEMENT_GRAIN), [&](qint64 first, qint64 end) {
+        PopulateDecrementVectorTask<T>(values, (int)first, (int)end, maxValue, rng).run();
+    }, m_job, "PopulateDecrementVectorTask");
+}
+
+qint64 DecrementProcessor::decrementToZero() {
+    appendToOutput(QString("Starting decrement process (%1, %2)...")
+                   .arg(m_mode == ActiveSet ? "active-set compaction" : "full rescan per pass")
+                   .arg(m_execution == PersistentTeam ? "persistent worker team" : "task continuations"));
+    QElapsedTimer timer;
+    timer.start();
+
+    int numThreads = m_pool->maxThreadCount();
+    if (numThreads == 0) {
+        appendToOutput("Error: Thread pool has 0 threads for decrementing.");
+        return -1;
+    }
+
+    // Several chunks per thread, cut like a parallelFor loop: chunks finish
+    // passes at different rates as their ranges drain, and the spare chunks
+    // keep every thread busy until the last few run dry.
+    const qint64 chunkSize = Grain::automatic(MIN_ELEMENT_GRAIN).blockSize(m_vectorSize, numThreads);
+    const int numChunks = (int)((m_vectorSize + chunkSize - 1) / chunkSize);
+    m_chunkNonZeroCounts.resize(numChunks); // QAtomicInt() is zero
+    m_chunkActive.assign(m_mode == ActiveSet ? numChunks : 0, std::vector<int>());
+    m_chunkListed.assign(m_chunkActive.size(), 0);
+
+    if (m_job) m_job->beginPhase("Decrementing to zero");
+    m_passesReported = 0;
+    if (m_execution == PersistentTeam) {
+        runTeamPasses(numChunks, (int)chunkSize);
+    } else {
+        // No barrier between passes: each chunk re-schedules itself for the
+        // next pass as soon as it finishes the current one, and stops once its
+        // own range is all zero. Pass totals are still reported in order.
+        TaskGraph graph(m_pool, m_job);
+        graph.setReportsProgress(false); // Progress is the fraction of elements already at zero
+        m_graph = &graph;
+        m_passOutstanding.assign(1, 0);
+        m_passNonZero.assign(1, 0);
+
+        for (int i = 0; i < numChunks; ++i) {
+            int start = (int)(i * chunkSize);
+            int end = (int)std::min<qint64>(start + chunkSize, m_vectorSize);
+            m_passOutstanding[0]++;
+            scheduleChunkPass(i, start, end, 0);
+        }
+        graph.wait();
+        m_graph = nullptr;
+    }
+    m_chunkActive.clear();
+    m_chunkListed.clear();
+
+    if (m_job && m_job->isCancelled()) {
+        appendToOutput(QString("Decrement process cancelled after %1 complete passes.").arg(m_passesReported));
+        return -1;
+    }
+    int passCount = m_passesReported;
+    qint64 elapsed = timer.elapsed();
+    appendToOutput(QString("Decrement process complete. All elements are zero. Took %1 passes.").arg(passCount));
+    return elapsed;
+}
+
+void DecrementProcessor::runTeamPasses(int numChunks, int chunkSize) {
+    // Members keep a contiguous run of chunks for every pass. Pass totals go
+    // through one padded slot per member, double-buffered by pass parity: a
+    // member that races ahead into pass p + 1 writes the other buffer, and
+    // cannot reach pass p + 2 before everyone has read pass p at the barrier.
+    // The calling thread is one of the members. A team cannot shrink
+    // between barriers, so it takes the job's share as it stands now.
+    const int maxMembers = m_job ? m_job->threadBudget(m_pool->maxThreadCount()) : m_pool->maxThreadCount();
+    PaddedSlots<long long> remaining(2 * maxMembers);
+    WorkerTeam team(m_pool);
+    team.run(maxMembers, [&](int member, int members) {
+        const int firstChunk = (int)((qint64)numChunks * member / members);
+        const int endChunk = (int)((qint64)numChunks * (member + 1) / members);
+        for (int pass = 0;; ++pass) {
+            long long live = 0;
+            for (int chunk = firstChunk; chunk < endChunk; ++chunk) {
+                int start = chunk * chunkSize;
+                int end = std::min(start + chunkSize, m_vectorSize);
+                live += runChunkPass(chunk, start, end, pass);
+            }
+            // Cancellation is published with the totals, so every member
+            // leaves after the same barrier.
+            remaining[2 * member + pass % 2] = (m_job && m_job->isCancelled()) ? -1 : live;
+            team.barrier();
+
+            long long total = 0;
+            bool cancelled = false;
+            for (int m = 0; m < members; ++m) {
+                long long slot = remaining[2 * m + pass % 2];
+                cancelled = cancelled || slot < 0;
+                total += slot;
+            }
+            if (cancelled) return;
+            if (member == 0) reportPass(total);
+            if (total == 0) return;
+        }
+    });
+}
+
+void DecrementProcessor::scheduleChunkPass(int chunk, int start, int end, int pass) {
+    m_graph->add([this, chunk, start, end, pass]() {
+        int next = pass;
+        int remaining = runChunkPass(chunk, start, end, next);
+        chunkPassFinished(next, remaining);
+        // A nearly drained ActiveSet chunk keeps going here: the pass is
+        // cheaper than the enqueue, and the spare threads are free for the
+        // chunks that still have work.
+        while (m_mode == ActiveSet && remaining > 0 && remaining < INLINE_PASS_LIMIT
+               && !(m_job && m_job->isCancelled())) {
+            remaining = runChunkPass(chunk, start, end, ++next);
+            chunkPassFinished(next, remaining);
+        }
+        if (remaining > 0) {
+            scheduleChunkPass(chunk, start, end, next + 1); // Continuation, no barrier
+        }
+    }, std::vector<TaskGraph::NodeId>(), m_mode == ActiveSet ? "DecrementActiveSetTask" : "DecrementChunkTask");
+}
+
+int DecrementProcessor::runChunkPass(int chunk, int start, int end, int pass) {
+    switch (m_data->width()) {
+    case BoundedIntVector::Width8: return runChunkPassAs<quint8>(chunk, start, end, pass);
+    case BoundedIntVector::Width16: return runChunkPassAs<quint16>(chunk, start, end, pass);
+    default: return runChunkPassAs<int>(chunk, start, end, pass);
+    }
+}
+
+template <typename T>
+int DecrementProcessor::runChunkPassAs(int chunk, int start, int end, int pass) {
+    const quint64 firstWord = (quint64)pass * (((quint64)m_vectorSize + 63) / 64);
+    T* values = m_data->data<T>();
+    if (m_mode == ActiveSet) {
+        DecrementActiveSetTask<T>(values, start, end, &m_chunkActive[chunk], &m_chunkListed[chunk], m_coins, firstWord,
+                                  &m_chunkNonZeroCounts[chunk]).run();
+    } else {
+        DecrementChunkTask<T>(values, start, end, m_coins, firstWord, &m_chunkNonZeroCounts[chunk]).run();
+    }
+    return m_chunkNonZeroCounts[chunk].load();
+}
+
+void DecrementProcessor::chunkPassFinished(int pass, int remaining) {
+    QMutexLocker locker(&m_passMutex);
+    m_passNonZero[pass] += remaining;
+    if (remaining > 0) {
+        // Register for the next pass before leaving this one, so pass p+1
+        // can only look complete once every chunk has finished pass p.
+        if ((int)m_passOutstanding.size() <= pass + 1) {
+            m_passOutstanding.push_back(0);
+            m_passNonZero.push_back(0);
+        }
+        m_passOutstanding[pass + 1]++;
+    }
+    m_passOutstanding[pass]--;
+
+    while (m_passesReported < (int)m_passOutstanding.size() && m_passOutstanding[m_passesReported] == 0) {
+        reportPass(m_passNonZero[m_passesReported]);
+    }
+}
+
+void DecrementProcessor::reportPass(long long remaining) {
+    appendToOutput(QString("Decrement Pass %1: %2 elements remaining > 0.").arg(m_passesReported + 1).arg(remaining));
+    if (m_job) m_job->updateProgress(m_vectorSize - remaining, m_vectorSize);
+    m_passesReported++;
+}
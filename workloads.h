@@ -0,0 +1,161 @@
+#ifndef WORKLOADS_H
+#define WORKLOADS_H
+
+#include "boundedvector.h"
+#include "counterrng.h"
+#include "workerteam.h"
+#include <QAtomicInt>
+#include <QMutex>
+#include <QString>
+#include <QtGlobal>
+#include <functional>
+#include <vector>
+
+class AsyncJob;
+class PackedStringMatrix;
+class QThreadPool;
+class TaskGraph;
+template <typename T, typename Compare> class ParallelSorter;
+template <typename T, typename Compare> class SliceSortCheck;
+
+// The demo workloads, independent of any UI so the GUI and the headless
+// benchmark run the same code. Progress text goes through appendToOutput()
+// (see outputlog.h); a null AsyncJob means no cancellation or progress.
+
+// Default problem sizes: the GUI's sizes and the benchmark's defaults.
+const int DEFAULT_VECTOR_SIZE = 10000000; // Original 100000000, reduced for quicker demo
+const int DEFAULT_STRING_MATRIX_ROWS = 5000;
+const int DEFAULT_STRING_MATRIX_COLS = 500;
+const int DEFAULT_STRING_LENGTH = 4;
+const int DEFAULT_DECREMENT_VECTOR_SIZE = 5000000;
+const int DEFAULT_MAX_RANDOM_VALUE_DECREMENT = 50;
+
+// === Task 1: number sort input ===
+
+// Fills *data with values in [1, maxValue] from the counter-based RNG, in
+// parallel. Element i gets counter firstIndex + i of the sort data stream, so
+// the same seed and firstIndex always produce the same data.
+void generateRandomInts(OverwriteVector<int>* data, QThreadPool* pool, quint64 seed, quint64 firstIndex, int maxValue,
+                        AsyncJob* job = nullptr);
+
+// The same values sorted by the same sorter, with generation and checking
+// fused into the sort (see ParallelSorter::pipelinedSort()): every generated
+// block and every merged slice is folded into *check by the worker that has
+// just written it, so data is sorted and verified without extra passes.
+void ingestRandomInts(ParallelSorter<int, std::less<int>>* sorter, OverwriteVector<int>* data, quint64 seed,
+                      quint64 firstIndex, int maxValue, SliceSortCheck<int, std::less<int>>* check,
+                      AsyncJob* job = nullptr);
+
+void printSample(const OverwriteVector<int>& vec, const QString& label);
+void printSample(const BoundedIntVector& vec, const QString& label);
+
+// === Task 2: String Matrix Population and Sorting ===
+
+class StringMatrixProcessor {
+private:
+    std::vector<std::vector<QString>>* m_matrix;
+    QThreadPool* m_pool;
+    int m_numRows;
+    int m_numCols;
+    int m_stringLength;
+    AsyncJob* m_job;
+
+public:
+    StringMatrixProcessor(std::vector<std::vector<QString>>* matrix, QThreadPool* pool, int rows, int cols, int strLen, AsyncJob* job = nullptr)
+        : m_matrix(matrix), m_pool(pool), m_numRows(rows), m_numCols(cols), m_stringLength(strLen), m_job(job) {}
+
+    void populate(quint64 seed); // Same cells as PackedStringMatrixProcessor for the seed
+    void sortRows();     // Each row on its own, rows spread over the pool
+    void sortGlobally(); // All cells as one sequence, written back row-major
+};
+
+// The same task on a PackedStringMatrix (see stringmatrix.h). Rows go to
+// parallelFor blocks of at least PACKED_MIN_ROWS_PER_BLOCK rows, and
+// characters come from the counter-based RNG, so a seed reproduces the matrix.
+const int PACKED_MIN_ROWS_PER_BLOCK = 16;
+
+class PackedStringMatrixProcessor {
+private:
+    PackedStringMatrix* m_matrix;
+    QThreadPool* m_pool;
+    int m_numRows;
+    int m_numCols;
+    int m_stringLength;
+    AsyncJob* m_job;
+
+public:
+    PackedStringMatrixProcessor(PackedStringMatrix* matrix, QThreadPool* pool, int rows, int cols, int strLen, AsyncJob* job = nullptr)
+        : m_matrix(matrix), m_pool(pool), m_numRows(rows), m_numCols(cols), m_stringLength(strLen), m_job(job) {}
+
+    void populate(quint64 seed);
+    void sortRows();
+};
+
+// === Task 3: Decrement Vector Elements ===
+
+class DecrementProcessor {
+public:
+    enum Mode {
+        FullScan, // Every pass rescans the chunk's whole range
+        ActiveSet // Once a chunk is sparse, its nonzero indices are listed and later passes walk and shrink the list
+    };
+
+    enum Execution {
+        TaskContinuations, // Each chunk re-enqueues itself per pass, no barrier
+        PersistentTeam     // One WorkerTeam runs all passes, each member on fixed chunks, meeting at a barrier
+    };
+
+    // An ActiveSet chunk with fewer live elements than this runs its next
+    // pass in the same node instead of re-enqueueing a near-empty task.
+    static const int INLINE_PASS_LIMIT = 4096;
+
+private:
+    BoundedIntVector* m_data; // Width chosen by populateVector() from the value range
+    QThreadPool* m_pool;
+    int m_vectorSize;
+    AsyncJob* m_job;
+    Mode m_mode;
+    Execution m_execution;
+    CounterRng m_coins; // Decrement coin flips, seeded by populateVector()
+    PaddedSlots<QAtomicInt> m_chunkNonZeroCounts; // Written by different workers in the same pass
+    std::vector<std::vector<int>> m_chunkActive; // ActiveSet: indices still > 0, per chunk
+    std::vector<char> m_chunkListed;             // ActiveSet: whether the chunk has switched to its list
+
+    // Per-pass bookkeeping for the barrier-free decrement loop
+    TaskGraph* m_graph;
+    QMutex m_passMutex;
+    std::vector<int> m_passOutstanding;    // Chunks that still have to finish pass p
+    std::vector<long long> m_passNonZero;  // Sum can be larger than int
+    int m_passesReported;
+
+public:
+    DecrementProcessor(BoundedIntVector* data, QThreadPool* pool, int vectorSize, AsyncJob* job = nullptr)
+        : m_data(data), m_pool(pool), m_vectorSize(vectorSize), m_job(job), m_mode(ActiveSet),
+          m_execution(TaskContinuations),
+          m_coins(0, CounterRng::DecrementCoinStream), m_graph(nullptr),
+          m_passesReported(0) {}
+
+    void setMode(Mode mode) { m_mode = mode; }
+    Mode mode() const { return m_mode; }
+    void setExecution(Execution execution) { m_execution = execution; }
+    Execution execution() const { return m_execution; }
+
+    // Resizes the vector to the narrowest width holding [0, maxValue] and fills it.
+    void populateVector(int maxValue, quint64 seed);
+
+    // Returns the elapsed milliseconds, or -1 if cancelled or the pool has no threads.
+    qint64 decrementToZero();
+
+    int passCount() const { return m_passesReported; }
+
+private:
+    template <typename T> void populateAs(int maxValue, quint64 seed);
+    void runTeamPasses(int numChunks, int chunkSize);
+    void scheduleChunkPass(int chunk, int start, int end, int pass);
+    int runChunkPass(int chunk, int start, int end, int pass);
+    template <typename T> int runChunkPassAs(int chunk, int start, int end, int pass);
+    void chunkPassFinished(int pass, int remaining);
+    void reportPass(long long remaining); // Reports pass m_passesReported + 1
+};
+
+#endif // WORKLOADS_H